@@ -0,0 +1,128 @@
+// AllocationTracker.cpp
+#include "AllocationTracker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+namespace {
+    std::atomic<size_t> allocationCount{ 0 };
+    thread_local bool armed = false;
+    thread_local bool trapping = false;
+}
+
+#ifdef IML_TRACK_ALLOCATIONS
+
+namespace {
+    void recordAllocation(std::size_t size) {
+        if (!armed) {
+            return;
+        }
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        if (trapping) {
+            armed = false;  // fprintf may allocate
+            std::fprintf(stderr, "AllocationTracker: heap allocation of %zu bytes in steady state\n", size);
+            std::abort();
+        }
+    }
+
+    // Over-aligned allocations need their own allocator and matching free
+    void* alignedMalloc(std::size_t size, std::size_t alignment) {
+#ifdef _MSC_VER
+        return _aligned_malloc(size ? size : 1, alignment);
+#else
+        // aligned_alloc wants a whole number of alignments
+        std::size_t rounded = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+        return std::aligned_alloc(alignment, rounded);
+#endif
+    }
+
+    void alignedFree(void* p) {
+#ifdef _MSC_VER
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}
+
+void* operator new(std::size_t size) {
+    recordAllocation(size);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    recordAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return ::operator new(size, tag);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    recordAllocation(size);
+    if (void* p = alignedMalloc(size, static_cast<std::size_t>(alignment))) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    recordAllocation(size);
+    return alignedMalloc(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+    return ::operator new(size, alignment, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+
+bool AllocationTracker::isEnabled() { return true; }
+
+#else
+
+bool AllocationTracker::isEnabled() { return false; }
+
+#endif // IML_TRACK_ALLOCATIONS
+
+void AllocationTracker::arm(bool trap) {
+    armed = true;
+    trapping = trap;
+}
+
+void AllocationTracker::disarm() {
+    armed = false;
+    trapping = false;
+}
+
+size_t AllocationTracker::getCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::resetCount() {
+    allocationCount.store(0, std::memory_order_relaxed);
+}
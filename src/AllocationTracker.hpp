@@ -0,0 +1,35 @@
+// AllocationTracker.hpp
+#ifndef ALLOCATION_TRACKER_HPP
+#define ALLOCATION_TRACKER_HPP
+
+#include <cstddef>
+
+// Debug aid for keeping the analysis hot loop off the heap. When the build
+// defines IML_TRACK_ALLOCATIONS, every global operator new (plain, nothrow
+// and over-aligned) is replaced and counts every allocation made on a thread
+// while it is armed; with trapping enabled the first such allocation aborts
+// so the debugger stops on the offending call. Without the define, arming is a no-op and the count stays 0.
+class AllocationTracker {
+public:
+    static bool isEnabled();
+
+    // Arm/disarm counting on the calling thread only, so capture and UI
+    // threads can allocate freely
+    static void arm(bool trap);
+    static void disarm();
+
+    // Allocations counted on any armed thread since the last resetCount()
+    static size_t getCount();
+    static void resetCount();
+
+    // Arms the current thread for the lifetime of the scope
+    class Scope {
+    public:
+        explicit Scope(bool trap) { arm(trap); }
+        ~Scope() { disarm(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+};
+
+#endif // ALLOCATION_TRACKER_HPP
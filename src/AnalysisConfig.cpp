@@ -0,0 +1,360 @@
+// AnalysisConfig.cpp
+#include "AnalysisConfig.hpp"
+#include "FeatureSnapshot.hpp"
+#include "Resampler.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace {
+    std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos) {
+            return "";
+        }
+        size_t last = text.find_last_not_of(" \t\r");
+        return text.substr(first, last - first + 1);
+    }
+
+    // Plain decimal digits only; values too large for size_t are rejected
+    bool parseSize(const std::string& text, size_t& value) {
+        if (text.empty() || !std::all_of(text.begin(), text.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            return false;
+        }
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // Rates are kept as unsigned int; a value that does not fit is bad, not wrapped
+    bool parseRate(const std::string& text, unsigned int& value) {
+        size_t number = 0;
+        if (!parseSize(text, number) || number > std::numeric_limits<unsigned int>::max()) {
+            return false;
+        }
+        value = static_cast<unsigned int>(number);
+        return true;
+    }
+
+    std::vector<std::string> splitList(const std::string& text) {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, ',')) {
+            parts.push_back(trim(part));
+        }
+        return parts;
+    }
+
+    bool parseInput(const std::string& text, InputConfig& input) {
+        std::vector<std::string> parts = splitList(text);
+        if (parts.size() < 2 || parts[0].empty()) {
+            return false;
+        }
+        input.label = parts[0];
+
+        if (parts[1] == "device") {
+            input.kind = InputKind::Device;
+            size_t channels = 1;
+            if (parts.size() >= 3 && !parseSize(parts[2], channels)) {
+                return false;
+            }
+            input.channelCount = static_cast<unsigned int>(channels);
+            // Device names may themselves contain commas
+            for (size_t i = 3; i < parts.size(); ++i) {
+                input.device += (i > 3 ? "," : "") + parts[i];
+            }
+            return true;
+        }
+        if (parts[1] == "file" && parts.size() == 3 && !parts[2].empty()) {
+            input.kind = InputKind::File;
+            input.path = parts[2];
+            return true;
+        }
+        return false;
+    }
+
+    bool parseNumber(const std::string& text, float& value) {
+        char* end = nullptr;
+        double number = std::strtod(text.c_str(), &end);
+        if (text.empty() || end != text.c_str() + text.size() || !std::isfinite(number)) {
+            return false;
+        }
+        value = static_cast<float>(number);
+        return true;
+    }
+
+    // "none", "envelope, attack, release", "one_euro, min_cutoff, beta" or
+    // "kalman, process_noise, measurement_noise"; omitted numbers keep their defaults
+    bool parseSmoothing(const std::string& text, SmoothingSettings& settings) {
+        std::vector<std::string> parts = splitList(text);
+        if (parts.empty()) {
+            return false;
+        }
+        settings = SmoothingSettings();
+        float* first = nullptr;
+        float* second = nullptr;
+        if (parts[0] == "none") {
+            settings.type = SmoothingType::None;
+        }
+        else if (parts[0] == "envelope") {
+            settings.type = SmoothingType::Envelope;
+            first = &settings.attack;
+            second = &settings.release;
+        }
+        else if (parts[0] == "one_euro") {
+            settings.type = SmoothingType::OneEuro;
+            first = &settings.minCutoff;
+            second = &settings.beta;
+        }
+        else if (parts[0] == "kalman") {
+            settings.type = SmoothingType::Kalman;
+            first = &settings.processNoise;
+            second = &settings.measurementNoise;
+        }
+        else {
+            return false;
+        }
+        if (parts.size() > (first ? 3u : 1u)) {
+            return false;
+        }
+        return (parts.size() < 2 || parseNumber(parts[1], *first))
+            && (parts.size() < 3 || parseNumber(parts[2], *second));
+    }
+
+    bool validSmoothing(const SmoothingSettings& settings) {
+        return settings.attack >= 0.0f && settings.release >= 0.0f && settings.minCutoff > 0.0f
+            && settings.beta >= 0.0f && settings.processNoise >= 0.0f && settings.measurementNoise > 0.0f;
+    }
+
+    bool parseWindow(const std::string& text, WindowType& window) {
+        if (text == "hann" || text == "hanning") { window = WindowType::Hann; return true; }
+        if (text == "hamming") { window = WindowType::Hamming; return true; }
+        if (text == "blackman") { window = WindowType::Blackman; return true; }
+        if (text == "rectangular" || text == "none") { window = WindowType::Rectangular; return true; }
+        return false;
+    }
+}
+
+bool AnalysisConfig::loadFromFile(const std::string& path, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "Could not open " + path;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            error = path + ":" + std::to_string(lineNumber) + ": expected key = value";
+            return false;
+        }
+        std::string key = trim(line.substr(0, equals));
+        std::string value = trim(line.substr(equals + 1));
+
+        bool ok = true;
+        if (key == "frame_size") {
+            ok = parseSize(value, frameSize);
+        }
+        else if (key == "hop_size") {
+            ok = parseSize(value, hopSize);
+        }
+        else if (key == "sample_rate") {
+            ok = parseRate(value, sampleRate);
+        }
+        else if (key == "analysis_rate") {
+            ok = parseRate(value, analysisRate);
+        }
+        else if (key == "tonal_frame_size") {
+            ok = parseSize(value, tonalFrameSize);
+        }
+        else if (key == "tonal_hop_size") {
+            ok = parseSize(value, tonalHopSize);
+        }
+        else if (key == "window") {
+            ok = parseWindow(value, window);
+        }
+        else if (key == "features") {
+            for (const std::string& feature : splitList(value)) {
+                ok = ok && !feature.empty();
+                features.push_back(feature);
+            }
+        }
+        else if (key == "tones") {
+            tones.clear();
+            for (const std::string& tone : splitList(value)) {
+                float hz = 0.0f;
+                ok = ok && parseNumber(tone, hz);
+                tones.push_back(hz);
+            }
+        }
+        else if (key == "tone_seconds") {
+            ok = parseNumber(value, toneSeconds);
+        }
+        else if (key == "noise_gate") {
+            ok = parseNumber(value, noiseGate);
+        }
+        else if (key == "noise_subtraction") {
+            ok = parseNumber(value, noiseSubtraction);
+        }
+        else if (key == "noise_floor_seconds") {
+            ok = parseNumber(value, noiseFloorSeconds);
+        }
+        else if (key == "fingerprint_index") {
+            ok = !value.empty();
+            fingerprintIndex = value;
+        }
+        else if (key == "follow_timeline") {
+            ok = !value.empty();
+            followTimeline = value;
+        }
+        else if (key == "normalize_seconds") {
+            ok = parseSize(value, normalizeSeconds);
+        }
+        else if (key.rfind("normalize_", 0) == 0 && findFeatureField(key.c_str() + 10) != nullptr) {
+            std::string field = key.substr(10);
+            auto existing = std::find_if(normalizeFields.begin(), normalizeFields.end(),
+                                         [&](const NormalizeWindow& window) { return window.field == field; });
+            if (existing == normalizeFields.end()) {
+                existing = normalizeFields.insert(normalizeFields.end(), { field });
+            }
+            ok = parseSize(value, existing->seconds);
+        }
+        else if (key == "smooth_volume") {
+            ok = parseSmoothing(value, volumeSmoothing);
+        }
+        else if (key == "smooth_centroid") {
+            ok = parseSmoothing(value, centroidSmoothing);
+        }
+        else if (key == "smooth_strobe") {
+            ok = parseSmoothing(value, strobeSmoothing);
+        }
+        else if (key == "input") {
+            InputConfig input;
+            ok = parseInput(value, input);
+            inputs.push_back(input);
+        }
+        else {
+            error = path + ":" + std::to_string(lineNumber) + ": unknown key '" + key + "'";
+            return false;
+        }
+
+        if (!ok) {
+            error = path + ":" + std::to_string(lineNumber) + ": bad value '" + value + "' for " + key;
+            return false;
+        }
+    }
+
+    return validate(error);
+}
+
+bool AnalysisConfig::validate(std::string& error) const {
+    std::ostringstream problem;
+    if (frameSize < 64 || (frameSize & (frameSize - 1)) != 0) {
+        problem << "frame_size must be a power of two of at least 64 (got " << frameSize << ")";
+    }
+    else if (hopSize == 0 || hopSize > frameSize) {
+        problem << "hop_size must be between 1 and frame_size (got " << hopSize << ")";
+    }
+    else if (tonalFrameSize != 0 && (tonalFrameSize < 64 || (tonalFrameSize & (tonalFrameSize - 1)) != 0)) {
+        problem << "tonal_frame_size must be 0 or a power of two of at least 64 (got " << tonalFrameSize << ")";
+    }
+    else if (tonalFrameSize != 0 && (getTonalHopSize() % hopSize != 0 || getTonalHopSize() > tonalFrameSize)) {
+        problem << "tonal_hop_size must be a multiple of hop_size no larger than tonal_frame_size (got "
+                << getTonalHopSize() << ")";
+    }
+    else if (sampleRate < 8000 || sampleRate > 384000) {
+        problem << "sample_rate must be between 8000 and 384000 Hz (got " << sampleRate << ")";
+    }
+    else if (analysisRate != 0 && (analysisRate < 8000 || analysisRate > 384000)) {
+        problem << "analysis_rate must be between 8000 and 384000 Hz (got " << analysisRate << ")";
+    }
+    else if (!Resampler::canConvert(sampleRate, getAnalysisRate())) {
+        problem << "sample_rate " << sampleRate << " to analysis_rate " << getAnalysisRate()
+                << " is not a simple enough ratio to resample";
+    }
+    else if (tones.size() > MAX_TONE_COUNT) {
+        problem << "at most " << MAX_TONE_COUNT << " tones can be tracked (got " << tones.size() << ")";
+    }
+    else if (std::any_of(tones.begin(), tones.end(), [&](float hz) { return hz <= 0.0f || hz >= getAnalysisRate() / 2.0f; })) {
+        problem << "tones must lie between 0 Hz and half the analysis rate";
+    }
+    else if (!(toneSeconds > 0.0f)) {
+        problem << "tone_seconds must be positive (got " << toneSeconds << ")";
+    }
+    else if (!(noiseGate >= 0.0f) || !(noiseSubtraction >= 0.0f)) {
+        problem << "noise_gate and noise_subtraction must not be negative";
+    }
+    else if (!(noiseFloorSeconds > 0.0f)) {
+        problem << "noise_floor_seconds must be positive (got " << noiseFloorSeconds << ")";
+    }
+    else if (!validSmoothing(volumeSmoothing) || !validSmoothing(centroidSmoothing) || !validSmoothing(strobeSmoothing)) {
+        problem << "smoothing times and noise must not be negative, cutoffs and measurement noise must be positive";
+    }
+
+    // SFML 2.5 keeps one capture device per process and captures at most two channels
+    size_t deviceInputs = 0;
+    for (size_t i = 0; i < inputs.size() && problem.str().empty(); ++i) {
+        const InputConfig& input = inputs[i];
+        if (input.kind == InputKind::Device) {
+            ++deviceInputs;
+            if (input.channelCount < 1 || input.channelCount > 2) {
+                problem << "input '" << input.label << "' must capture 1 or 2 channels";
+            }
+        }
+        for (size_t j = 0; j < i; ++j) {
+            if (inputs[j].label == input.label) {
+                problem << "input label '" << input.label << "' is used twice";
+            }
+        }
+    }
+    if (problem.str().empty() && deviceInputs > 1) {
+        problem << "only one capture device input is supported; use file inputs for additional feeds";
+    }
+
+    error = problem.str();
+    return error.empty();
+}
+
+size_t AnalysisConfig::getNormalizeHops(const std::string& field) const {
+    size_t seconds = field == "volume" || field == "centroid" || field == "strobe" ? normalizeSeconds : 0;
+    for (const NormalizeWindow& window : normalizeFields) {
+        if (window.field == field) {
+            seconds = window.seconds;
+        }
+    }
+    return seconds * getAnalysisRate() / hopSize;
+}
+
+std::vector<size_t> AnalysisConfig::getNormalizeWindows() const {
+    std::vector<size_t> windows;
+    for (const char* field : { "volume", "centroid", "strobe" }) {
+        windows.push_back(getNormalizeHops(field));
+    }
+    for (const NormalizeWindow& window : normalizeFields) {
+        windows.push_back(getNormalizeHops(window.field));
+    }
+    std::sort(windows.begin(), windows.end());
+    windows.erase(std::unique(windows.begin(), windows.end()), windows.end());
+    windows.erase(std::remove(windows.begin(), windows.end(), 0), windows.end());
+    return windows;
+}
+
+std::vector<InputConfig> AnalysisConfig::getInputs() const {
+    if (inputs.empty()) {
+        return { InputConfig() };
+    }
+    return inputs;
+}
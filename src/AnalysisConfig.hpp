@@ -0,0 +1,125 @@
+// AnalysisConfig.hpp
+#ifndef ANALYSIS_CONFIG_HPP
+#define ANALYSIS_CONFIG_HPP
+
+#include "Smoothing.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class WindowType {
+    Hann,
+    Hamming,
+    Blackman,
+    Rectangular
+};
+
+enum class InputKind {
+    Device,     // Live capture through SFML
+    File        // WAV file played back in real time, e.g. pre-recorded stems at rehearsal
+};
+
+// One audio input. Device inputs may capture 1 or 2 channels; every channel
+// gets its own analysis pipeline, labelled "<label>.<n>" when there are several.
+struct InputConfig {
+    std::string label = "main";
+    InputKind kind = InputKind::Device;
+    unsigned int channelCount = 1;
+    std::string device;      // Capture device name, empty for the system default
+    std::string path;        // WAV path for file inputs
+};
+
+// Adaptive normalisation window of one published field (normalize_<field> = seconds)
+struct NormalizeWindow {
+    std::string field;
+    size_t seconds = 0;
+};
+
+// Analysis parameters chosen at run time. Loaded from a plain-text file of
+// "key = value" lines; '#' starts a comment. Keys that are not present keep
+// the defaults below.
+//
+//   frame_size  = 1024     # samples per analysis frame (power of two)
+//   hop_size    = 512      # samples between frames
+//   sample_rate = 48000    # rate requested from the capture device
+//   analysis_rate = 48000  # rate the features are computed at (default: sample_rate)
+//   window      = hann     # hann | hamming | blackman | rectangular
+//   tonal_frame_size = 4096  # long frames for chroma/key/chord (0 = use frame_size)
+//   tonal_hop_size = 1024    # a multiple of hop_size (default: a quarter frame)
+//   features    = onset, mel_bands   # extra features to compute (see FeatureNodes.hpp)
+//   normalize_seconds = 20  # lighting values span their recent 5th-95th percentile (0 = fixed 0-1)
+//   normalize_band_levels = 5   # map a published measurement onto its own recent range too
+//   normalize_volume = 60       # per-value window, overriding normalize_seconds (0 = fixed 0-1)
+//   smooth_volume = envelope, 0.05, 0.05   # attack, release seconds (also smooth_centroid, smooth_strobe)
+//   smooth_centroid = one_euro, 1.0, 0.5   # cutoff at rest in Hz, cutoff increase per unit/s
+//   smooth_strobe = kalman, 1.0, 0.01      # variance growth per second, measurement variance
+//   smooth_volume = none
+//   tones       = 55, 110, 220   # frequencies (Hz, up to 64) tracked sample by sample
+//   tone_seconds = 0.05    # response time of the tracked tones
+//   noise_gate  = 6        # skip the analysis while the input is within 6 dB of the noise floor (0 = off)
+//   noise_subtraction = 1.5  # take 1.5 noise floors off rms and the spectrum (0 = off)
+//   noise_floor_seconds = 300  # the noise floor is the quietest level of this window
+//   fingerprint_index = features/setlist.imfp   # recognise tracks pre-analysed by BatchAnalyzer
+//   follow_timeline = features/track01.imft     # follow a live performance of one pre-analysed track
+//   input       = mix, device, 2, Focusrite USB   # label, device, channels[, name]
+//   input       = vocals, file, stems/vocals.wav  # label, file, path
+//
+// "input" may repeat; each input is analysed on its own thread. Without any
+// input lines a single mono capture from the default device is used. The
+// features the lighting needs are always computed; "features" adds more.
+// The noise floor is the quietest audio of its window, so noise_gate and
+// noise_subtraction need the analysis to start on the room noise: started
+// into music, they treat its quietest passages as noise until a pause comes.
+// Published measurements keep their units unless a normalize_<field> line
+// gives them a window; labels, pulses, delays and positions always do.
+struct AnalysisConfig {
+    size_t frameSize = 1024;
+    size_t hopSize = 512;
+    unsigned int sampleRate = 44100;
+    unsigned int analysisRate = 0;   // 0 means analyse at sampleRate
+    WindowType window = WindowType::Hann;
+    size_t tonalFrameSize = 0;       // 0 means tonal features use frameSize
+    size_t tonalHopSize = 0;         // 0 means about a quarter of tonalFrameSize
+    std::vector<InputConfig> inputs;
+    std::vector<std::string> features;
+    std::vector<float> tones;
+    float toneSeconds = 0.05f;
+    float noiseGate = 0.0f;          // dB above the noise floor; 0 = no gate
+    float noiseSubtraction = 0.0f;   // 0 = no spectral subtraction
+    float noiseFloorSeconds = 300.0f;
+    std::string fingerprintIndex;
+    std::string followTimeline;
+    size_t normalizeSeconds = 20;
+    std::vector<NormalizeWindow> normalizeFields;
+    SmoothingSettings volumeSmoothing;
+    SmoothingSettings centroidSmoothing;
+    SmoothingSettings strobeSmoothing = { SmoothingType::Envelope, 0.0f, 0.03f };   // Jumps up on hits
+
+    // Returns false with a description in error if the file cannot be read,
+    // contains unknown keys or bad values, or fails validate()
+    bool loadFromFile(const std::string& path, std::string& error);
+
+    bool validate(std::string& error) const;
+
+    // Rate the pipeline resamples every input to before analysis
+    unsigned int getAnalysisRate() const { return analysisRate ? analysisRate : sampleRate; }
+
+    // Hop of the tonal frames, a multiple of hopSize; only meaningful when tonalFrameSize is set
+    size_t getTonalHopSize() const {
+        return tonalHopSize ? tonalHopSize : std::max(hopSize, tonalFrameSize / 4 / hopSize * hopSize);
+    }
+
+    // Hops per adaptive normalisation window of a published field, 0 when it
+    // keeps its units; volume, centroid and strobe default to normalizeSeconds
+    size_t getNormalizeHops(const std::string& field) const;
+    // Every distinct window in use, in hops
+    std::vector<size_t> getNormalizeWindows() const;
+    // First hop whose frame holds no initial silence; normalisation windows count from it
+    size_t getFirstFullHop() const { return (frameSize + hopSize - 1) / hopSize - 1; }
+
+    // The configured inputs, or the default mono device input if none are listed
+    std::vector<InputConfig> getInputs() const;
+};
+
+#endif // ANALYSIS_CONFIG_HPP
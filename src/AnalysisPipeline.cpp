@@ -0,0 +1,469 @@
+// AnalysisPipeline.cpp
+#include "AnalysisPipeline.hpp"
+#include "FeatureNodes.hpp"
+#include "TimelineFollower.hpp"
+#include "TrackMatcher.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+// Graph outputs that land in FeatureSnapshot: node, first float, field name,
+// whether the value only marks the hop it is produced on and, for pulses,
+// the field saying how long before the hop the event happened
+struct PublishedFeature {
+    const char* node;
+    size_t first;
+    const char* field;
+    bool pulse = false;
+    const char* delay = nullptr;
+};
+
+const PublishedFeature PUBLISHED_FEATURES[] = {
+    { "rms",       0, "rms" },
+    { "centroid",  0, "centroid_hz" },
+    { "loudness",  0, "loudness_momentary" },
+    { "loudness",  1, "loudness_short_term" },
+    { "flux",      0, "flux" },
+    { "onset",     0, "onset_strength" },
+    { "onset",     1, "onset", true },
+    { "mel_bands", 0, "mel_bands" },
+    { "chroma",    0, "chroma" },
+    { "key",       0, "key" },
+    { "key",       1, "key_strength" },
+    { "chord",     0, "chord" },
+    { "chord",     1, "chord_confidence" },
+    { "chord",     2, "chord_change", true },
+    { "pitch",     0, "pitch" },
+    { "pitch",     1, "pitch_confidence" },
+    { "hpss_energy", 0, "harmonic" },
+    { "hpss_energy", 1, "percussive" },
+    { "drums",     0, "kick", true, "hit_delay" },
+    { "drums",     1, "snare", true, "hit_delay" },
+    { "drums",     2, "hihat", true, "hit_delay" },
+    { "drums",     3, "hit_delay" },
+    { "crossover", 0, "band_levels" },
+    { "crossover", CROSSOVER_BAND_COUNT, "bass_hit", true, "bass_hit_delay" },
+    { "crossover", CROSSOVER_BAND_COUNT + 1, "bass_hit_delay" },
+    { "tones",     0, "tones" },
+    { "sections",  0, "novelty" },
+    { "sections",  1, "section_change", true },
+    { "sections",  2, "section" },
+    { "drop",      0, "drop_probability" },
+    { "drop",      1, "drop_countdown" },
+    { "drop",      2, "drop", true },
+    { "track_match", 0, "matched_track" },
+    { "track_match", 1, "track_position" },
+    { "track_match", 2, "match_votes" },
+    { "timeline_follow", 0, "reference_position" },
+    { "timeline_follow", 1, "follow_cost" },
+};
+
+// Narrowest ranges the lighting values are stretched over, so a noise floor
+// or a steady tone does not flicker across the full output
+const double MIN_LEVEL_SPAN = 0.01;       // RMS, about -40 dBFS
+const double MIN_CENTROID_SPAN = 200.0;   // Hz
+const double MIN_PITCH_SPAN = 100.0;      // Hz
+const double MIN_LOUDNESS_SPAN = 6.0;     // LU
+const double MIN_LOG_SPAN = 0.1;          // Log-compressed magnitudes and their differences
+const double MIN_SCORE_SPAN = 0.1;        // Scores and confidences of 0-1
+
+// Published measurements that may be mapped onto their recent range
+// (normalize_<field>), with the narrowest range each is stretched over.
+// Labels, pulses, delays and positions keep their units, and so does
+// key_strength, whose 0 says no key is known.
+struct NormalizableField {
+    const char* field;
+    double minSpan;
+};
+
+const NormalizableField NORMALIZABLE_FIELDS[] = {
+    { "rms",                 MIN_LEVEL_SPAN },
+    { "centroid_hz",         MIN_CENTROID_SPAN },
+    { "loudness_momentary",  MIN_LOUDNESS_SPAN },
+    { "loudness_short_term", MIN_LOUDNESS_SPAN },
+    { "flux",                MIN_LOG_SPAN },
+    { "onset_strength",      MIN_LOG_SPAN },
+    { "mel_bands",           MIN_LOG_SPAN },
+    { "chroma",              MIN_SCORE_SPAN },
+    { "chord_confidence",    MIN_SCORE_SPAN },
+    { "pitch",               MIN_PITCH_SPAN },
+    { "pitch_confidence",    MIN_SCORE_SPAN },
+    { "harmonic",            MIN_LEVEL_SPAN },
+    { "percussive",          MIN_LEVEL_SPAN },
+    { "band_levels",         MIN_LEVEL_SPAN },
+    { "tones",               MIN_LEVEL_SPAN },
+    { "novelty",             MIN_SCORE_SPAN },
+    { "drop_probability",    MIN_SCORE_SPAN },
+    { "follow_cost",         MIN_LOG_SPAN },
+};
+
+// The gate stays open this long after the input last rose above it, so
+// decays and short pauses inside a song are analysed
+const double GATE_HOLD_SECONDS = 2.0;
+// Minimum-statistics bias of the per-hop power of broadband noise
+const float GATE_BIAS = 1.05f;
+
+// Lanes of the smoothing bank
+const size_t VOLUME_LANE = 0;
+const size_t CENTROID_LANE = 1;
+const size_t STROBE_LANE = 2;
+const size_t SMOOTHED_LANES = 3;
+
+FrameContext makeFrameContext(const AnalysisConfig& config) {
+    FrameContext context;
+    context.frameSize = config.frameSize;
+    context.hopSize = config.hopSize;
+    context.sampleRate = config.getAnalysisRate();
+    context.window = config.window;
+    context.noiseSubtraction = config.noiseSubtraction;
+    context.noiseFloorSeconds = config.noiseFloorSeconds;
+    return context;
+}
+
+FrameContext makeTonalContext(const AnalysisConfig& config) {
+    FrameContext context = makeFrameContext(config);
+    if (config.tonalFrameSize != 0) {
+        context.frameSize = config.tonalFrameSize;
+        context.hopSize = config.getTonalHopSize();
+    }
+    return context;
+}
+
+} // namespace
+
+AnalysisPipeline::AnalysisPipeline(const AnalysisConfig& config, unsigned int inputRate)
+    : frameSize(config.frameSize)
+    , hopSize(config.hopSize)
+    , sampleRate(config.getAnalysisRate())
+    , tonalFrameSize(config.tonalFrameSize)
+    , tonalHopRatio(config.tonalFrameSize ? config.getTonalHopSize() / config.hopSize : 0)
+    , historySize(std::max(frameSize, tonalFrameSize))
+    , resampler(inputRate ? inputRate : config.sampleRate, config.getAnalysisRate())
+    , graph(makeFrameContext(config))
+    , tonalGraph(makeTonalContext(config))
+    , hopsUntilTonal(0)
+    , buffer(historySize + std::max(sampleRate, 4 * hopSize), 0)  // Room for a second of pending audio
+    , bufferedEnd(0)
+    , frameEnd(0)
+    , samplesConsumed(0)
+    , gateFloor(1, static_cast<double>(config.hopSize) / config.getAnalysisRate(), config.noiseFloorSeconds, GATE_BIAS)
+    , gateRatio(config.noiseGate > 0.0f ? std::pow(10.0f, config.noiseGate / 10.0f) : 0.0f)
+    , gateHoldHops(std::max<size_t>(1, static_cast<size_t>(GATE_HOLD_SECONDS * config.getAnalysisRate() / config.hopSize)))
+    , hopsBelowGate(0)
+    , smoothing(SMOOTHED_LANES, static_cast<double>(config.hopSize) / config.getAnalysisRate())
+    , adaptiveVolume(config.getNormalizeHops("volume") > 0)
+    , adaptiveCentroid(config.getNormalizeHops("centroid") > 0)
+    , adaptiveStrobe(config.getNormalizeHops("strobe") > 0)
+    , volumeRange(config.getNormalizeHops("volume"), MIN_LEVEL_SPAN)
+    , centroidRange(config.getNormalizeHops("centroid"), MIN_CENTROID_SPAN)
+    , strobeRange(config.getNormalizeHops("strobe"), MIN_LEVEL_SPAN)
+{
+    smoothing.configure(VOLUME_LANE, config.volumeSmoothing);
+    smoothing.configure(CENTROID_LANE, config.centroidSmoothing);
+    smoothing.configure(STROBE_LANE, config.strobeSmoothing);
+
+    addStandardNodes(graph);
+    graph.subscribe("rms");
+    graph.subscribe("centroid");
+    if (!config.fingerprintIndex.empty()) {
+        graph.addNode(std::make_unique<TrackMatchNode>(config.fingerprintIndex));
+        graph.subscribe("track_match");
+    }
+    if (!config.tones.empty()) {
+        graph.addNode(std::make_unique<ToneNode>(config.tones, config.toneSeconds));
+        graph.subscribe("tones");
+    }
+    if (!config.followTimeline.empty()) {
+        graph.addNode(std::make_unique<TimelineFollowNode>(config.followTimeline));
+        graph.subscribe("timeline_follow");
+    }
+    // Tonal features go to the long-frame graph when there is one
+    if (tonalHopRatio > 0) {
+        addStandardNodes(tonalGraph);
+    }
+    for (const std::string& feature : config.features) {
+        bool tonal = tonalHopRatio > 0 && graph.getResolution(feature) == FrameResolution::Tonal;
+        (tonal ? tonalGraph : graph).subscribe(feature);
+    }
+    graph.compile();
+    tonalGraph.compile();
+
+    rmsNode = graph.findScheduled("rms");
+    centroidNode = graph.findScheduled("centroid");
+    hpssEnergyNode = graph.findScheduled("hpss_energy");
+    noiseFloorNode = graph.findScheduled("noise_floor");
+    for (const PublishedFeature& published : PUBLISHED_FEATURES) {
+        const FeatureGraph* source = &graph;
+        size_t node = graph.findScheduled(published.node);
+        if (node == FeatureGraph::NO_NODE) {
+            source = &tonalGraph;
+            node = tonalGraph.findScheduled(published.node);
+        }
+        const FeatureField* field = findFeatureField(published.field);
+        if (node == FeatureGraph::NO_NODE || field == nullptr) {
+            continue;
+        }
+        size_t available = source->getOutput(node).size() - published.first;
+        publications.push_back({ source, node, published.first, std::min(field->count, available),
+                                 featureData(snapshot, *field), published.pulse });
+        if (published.pulse) {
+            const FeatureField* delay = published.delay ? findFeatureField(published.delay) : nullptr;
+            for (size_t i = 0; i < publications.back().count; ++i) {
+                heldPulses.push_back({ field, i, delay });
+            }
+        }
+    }
+
+    for (const NormalizeWindow& window : config.normalizeFields) {
+        size_t windowHops = config.getNormalizeHops(window.field);
+        if (windowHops == 0 || window.field == "volume" || window.field == "centroid" || window.field == "strobe") {
+            continue;
+        }
+        const NormalizableField* normalizable = std::find_if(std::begin(NORMALIZABLE_FIELDS), std::end(NORMALIZABLE_FIELDS),
+            [&](const NormalizableField& candidate) { return window.field == candidate.field; });
+        if (normalizable == std::end(NORMALIZABLE_FIELDS)) {
+            throw std::runtime_error("normalize_" + window.field + ": only measurements can be normalised");
+        }
+        const float* target = featureData(snapshot, *findFeatureField(normalizable->field));
+        auto publication = std::find_if(publications.begin(), publications.end(),
+                                        [&](const Publication& candidate) { return candidate.target == target; });
+        if (publication == publications.end()) {
+            throw std::runtime_error("normalize_" + window.field + ": its feature is not computed; add it to features");
+        }
+        const float* source = publication->graph->getOutput(publication->node).data() + publication->first;
+        for (size_t i = 0; i < publication->count; ++i) {
+            normalizedValues.push_back({ source + i, publication->target + i,
+                                         QuantileRange(windowHops, normalizable->minSpan) });
+        }
+    }
+
+    reset();
+}
+
+void AnalysisPipeline::reset() {
+    // Start with a frame of silence so the first hop is analysed as soon as
+    // hopSize samples have arrived
+    std::fill(buffer.begin(), buffer.begin() + historySize, static_cast<std::int16_t>(0));
+    bufferedEnd = historySize;
+    frameEnd = historySize;
+    samplesConsumed = 0;
+    hopsUntilTonal = tonalHopRatio;
+    gateFloor.reset();
+    hopsBelowGate = 0;
+    snapshot = FeatureSnapshot();
+    smoothing.reset();
+    volumeRange.reset();
+    centroidRange.reset();
+    strobeRange.reset();
+    for (NormalizedValue& normalized : normalizedValues) {
+        normalized.range.reset();
+    }
+    resampler.reset();
+    graph.reset();
+    tonalGraph.reset();
+    for (HeldPulse& held : heldPulses) {
+        held.value = 0.0f;
+    }
+}
+
+const FeatureSnapshot& AnalysisPipeline::collectSnapshot() {
+    collected = snapshot;
+    // Delay fields shared by several pulses give the latest of their events
+    for (const HeldPulse& held : heldPulses) {
+        if (held.value > 0.0f && held.delay) {
+            featureData(collected, *held.delay)[0] = std::numeric_limits<float>::max();
+        }
+    }
+    for (HeldPulse& held : heldPulses) {
+        if (held.value > 0.0f) {
+            featureData(collected, *held.field)[held.index] = held.value;
+            if (held.delay) {
+                float& delay = featureData(collected, *held.delay)[0];
+                delay = std::min(delay, static_cast<float>(snapshot.time - held.eventTime));
+            }
+        }
+        held.value = 0.0f;
+    }
+    return collected;
+}
+
+double AnalysisPipeline::getSettleSeconds() const {
+    return std::max(graph.getSettleSeconds(), tonalGraph.getSettleSeconds());
+}
+
+size_t AnalysisPipeline::getAlignmentHops() const {
+    // Tonal frames fall on whole tonal hops from the start, and tonal nodes
+    // count their blocks in tonal frames
+    size_t tonalHops = tonalHopRatio > 0 ? tonalHopRatio * tonalGraph.getBlockFrames() : 1;
+    return std::lcm(graph.getBlockFrames(), tonalHops);
+}
+
+size_t AnalysisPipeline::pushSamples(const std::int16_t* samples, size_t count) {
+    if (bufferedEnd + resampler.getMaxOutput(count) > buffer.size()) {
+        compactBuffer();
+    }
+
+    size_t space = buffer.size() - bufferedEnd;
+    size_t accepted = std::min(count, resampler.getMaxInput(space));
+    bufferedEnd += resampler.process(samples, accepted, buffer.data() + bufferedEnd, space);
+    return accepted;
+}
+
+void AnalysisPipeline::compactBuffer() {
+    // Drop samples that no future frame can reach
+    size_t keepFrom = frameEnd - historySize;
+    if (keepFrom == 0) {
+        return;
+    }
+    std::copy(buffer.begin() + keepFrom, buffer.begin() + bufferedEnd, buffer.begin());
+    bufferedEnd -= keepFrom;
+    frameEnd -= keepFrom;
+}
+
+bool AnalysisPipeline::processHop() {
+    if (bufferedEnd < frameEnd + hopSize) {
+        return false;
+    }
+
+    frameEnd += hopSize;
+    samplesConsumed += hopSize;
+
+    // Between songs only crowd and room noise comes in. The gate compares the
+    // power of the new hop with its noise floor and holds both graphs while
+    // it stays close, which also saves their CPU time.
+    bool open = true;
+    if (gateRatio > 0.0f) {
+        const std::int16_t* hop = buffer.data() + frameEnd - hopSize;
+        double sum = 0.0;
+        for (size_t i = 0; i < hopSize; ++i) {
+            float sample = hop[i] / 32768.0f;
+            sum += sample * sample;
+        }
+        float level = static_cast<float>(sum / hopSize);
+        gateFloor.update(&level);
+        hopsBelowGate = level > gateRatio * gateFloor.getFloor(0) ? 0 : std::min(hopsBelowGate + 1, gateHoldHops);
+        open = hopsBelowGate < gateHoldHops;
+        snapshot.noiseFloor = std::sqrt(gateFloor.getFloor(0));
+        snapshot.gate = open ? 1.0f : 0.0f;
+    }
+    if (open) {
+        graph.process(buffer.data() + frameEnd - frameSize);
+    }
+    // Without the gate the noise subtraction's floor is the room noise
+    if (gateRatio == 0.0f && noiseFloorNode != FeatureGraph::NO_NODE) {
+        snapshot.noiseFloor = std::sqrt(graph.getOutput(noiseFloorNode).back());
+    }
+
+    // The tonal graph runs on whole tonal hops counted from the first sample
+    bool tonalRan = false;
+    if (tonalHopRatio > 0 && --hopsUntilTonal == 0) {
+        if (open) {
+            tonalGraph.process(buffer.data() + frameEnd - tonalFrameSize);
+        }
+        hopsUntilTonal = tonalHopRatio;
+        tonalRan = open;
+    }
+
+    // Outputs of a graph that did not run keep their last values
+    snapshot.time = static_cast<double>(samplesConsumed) / sampleRate;
+    for (const Publication& publication : publications) {
+        if (!(publication.graph == &tonalGraph ? tonalRan : open)) {
+            if (publication.pulse) {
+                std::fill_n(publication.target, publication.count, 0.0f);
+            }
+            continue;
+        }
+        std::span<const float> output = publication.graph->getOutput(publication.node);
+        std::copy_n(output.data() + publication.first, publication.count, publication.target);
+    }
+
+    // Keep the strongest of each pulse until collectSnapshot() hands it out
+    for (HeldPulse& held : heldPulses) {
+        float value = featureData(snapshot, *held.field)[held.index];
+        if (value > 0.0f && value >= held.value) {
+            held.value = value;
+            held.eventTime = snapshot.time - (held.delay ? featureData(snapshot, *held.delay)[0] : 0.0f);
+        }
+    }
+
+    // With the harmonic/percussive split, sustained energy drives the wash and
+    // hits drive the strobe, so a loud pad no longer drowns the drums
+    float targetVolume = graph.getOutput(rmsNode)[0];
+    float targetCentroid = graph.getOutput(centroidNode)[0];
+    float targetStrobe = 0.0f;
+    if (hpssEnergyNode != FeatureGraph::NO_NODE) {
+        targetVolume = graph.getOutput(hpssEnergyNode)[0];
+        targetStrobe = graph.getOutput(hpssEnergyNode)[1];
+    }
+    // Behind the gate the input counts as silence; the colour stays put
+    if (!open) {
+        snapshot.rms = 0.0f;
+        targetVolume = 0.0f;
+        targetStrobe = 0.0f;
+    }
+
+    // Map each value onto its recent range, so neither the input gain nor the
+    // centroid's units decide how bright or which colour the lights are.
+    // Frames still holding the initial silence are left out, so the ranges
+    // (and their window clock) start at AnalysisConfig::getFirstFullHop();
+    // so are hops behind the gate.
+    bool measured = open && samplesConsumed >= frameSize;
+    if (adaptiveVolume) {
+        if (measured) {
+            volumeRange.add(targetVolume);
+        }
+        targetVolume = volumeRange.normalize(targetVolume);
+    }
+    if (adaptiveCentroid) {
+        if (measured) {
+            centroidRange.add(targetCentroid);
+        }
+        targetCentroid = centroidRange.normalize(targetCentroid);
+    }
+    if (adaptiveStrobe) {
+        if (measured) {
+            strobeRange.add(targetStrobe);
+        }
+        if (hpssEnergyNode != FeatureGraph::NO_NODE) {
+            targetStrobe = strobeRange.normalize(targetStrobe);
+        }
+    }
+
+    // Published measurements given a window go the same way, each float on
+    // its own range. Tonal values count every hop, holding between tonal
+    // hops, so all windows run on the one hop clock. Behind the gate they
+    // keep what they last showed.
+    if (open) {
+        for (NormalizedValue& normalized : normalizedValues) {
+            if (measured) {
+                normalized.range.add(*normalized.source);
+            }
+            *normalized.target = normalized.range.normalize(*normalized.source);
+        }
+    }
+
+    // Smooth and normalize values; by default the strobe jumps up and only smooths on release
+    smoothing.input(VOLUME_LANE) = targetVolume;
+    smoothing.input(CENTROID_LANE) = targetCentroid;
+    smoothing.input(STROBE_LANE) = targetStrobe;
+    smoothing.process();
+    snapshot.volume = smoothing.getValue(VOLUME_LANE);
+    snapshot.centroid = smoothing.getValue(CENTROID_LANE);
+    snapshot.strobe = smoothing.getValue(STROBE_LANE);
+
+    normalizeValue(snapshot.volume);
+    normalizeValue(snapshot.centroid);
+    normalizeValue(snapshot.strobe);
+
+    return true;
+}
+
+void AnalysisPipeline::normalizeValue(float& value, float minValue, float maxValue) {
+    value = std::clamp(value, minValue, maxValue);
+    value = (value - minValue) / (maxValue - minValue);
+}
@@ -0,0 +1,138 @@
+// AnalysisPipeline.hpp
+#ifndef ANALYSIS_PIPELINE_HPP
+#define ANALYSIS_PIPELINE_HPP
+
+#include "AnalysisConfig.hpp"
+#include "FeatureGraph.hpp"
+#include "FeatureSnapshot.hpp"
+#include "NoiseFloor.hpp"
+#include "Resampler.hpp"
+#include "Smoothing.hpp"
+#include "StreamingQuantile.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Hop-driven analysis of a mono sample stream. Input arrives at the source's
+// rate and is first resampled to the configured analysis rate. Samples are pushed in whatever
+// chunk sizes the source delivers; each processHop() call analyses the next
+// frame, so the output depends only on the input samples and never on how
+// often the caller polls. Live capture and file replay share this path.
+// Features come from a FeatureGraph holding only what the lighting needs plus
+// config.features. With config.tonalFrameSize set, features whose nodes ask
+// for FrameResolution::Tonal run in a second graph on long frames ending at
+// the same sample, every tonal hop; both read the one sample buffer. With
+// config.noiseGate set, neither graph runs while the input stays near the
+// room noise floor. All buffers are sized in the constructor; once running,
+// processHop() allocates nothing.
+class AnalysisPipeline {
+private:
+    size_t frameSize;
+    size_t hopSize;
+    size_t sampleRate;   // Analysis rate
+    size_t tonalFrameSize;
+    size_t tonalHopRatio;   // Hops per tonal hop, 0 without a tonal graph
+    size_t historySize;     // Samples the longest frame reaches back
+
+    // Copies one graph output into the snapshot
+    struct Publication {
+        const FeatureGraph* graph;
+        size_t node;
+        size_t first;    // First float of the node output
+        size_t count;
+        float* target;
+        bool pulse;      // Cleared on hops its graph does not run
+    };
+
+    Resampler resampler;
+    FeatureGraph graph;
+    FeatureGraph tonalGraph;
+    size_t hopsUntilTonal;
+    FeatureSnapshot snapshot;
+    std::vector<Publication> publications;
+
+    // Strongest value of one pulse float since the last collectSnapshot()
+    struct HeldPulse {
+        const FeatureField* field;
+        size_t index;
+        const FeatureField* delay;   // Its delay field, or nullptr
+        float value = 0.0f;
+        double eventTime = 0.0;      // Stream time of the held event
+    };
+    std::vector<HeldPulse> heldPulses;
+    FeatureSnapshot collected;
+    size_t rmsNode;
+    size_t centroidNode;
+    size_t hpssEnergyNode;   // NO_NODE unless hpss_energy is subscribed
+    size_t noiseFloorNode;   // NO_NODE unless noise_floor is scheduled
+
+    // Fixed-capacity sample buffer holding [0, bufferedEnd). frameEnd is the
+    // index one past the last sample of the most recently analysed frame.
+    std::vector<std::int16_t> buffer;
+    size_t bufferedEnd;
+    size_t frameEnd;
+    size_t samplesConsumed;
+
+    void compactBuffer();
+
+    // Holds the analysis while only room noise comes in (AnalysisConfig::noiseGate)
+    NoiseFloor gateFloor;
+    float gateRatio;        // Hop power over the noise floor that opens the gate, 0 = no gate
+    size_t gateHoldHops;    // Hops below the gate before it closes
+    size_t hopsBelowGate;
+
+    // Volume, centroid and strobe, smoothed as configured
+    SmoothingBank smoothing;
+
+    // Recent ranges the lighting values are normalised to (AnalysisConfig::getNormalizeHops)
+    bool adaptiveVolume;
+    bool adaptiveCentroid;
+    bool adaptiveStrobe;
+    QuantileRange volumeRange;
+    QuantileRange centroidRange;
+    QuantileRange strobeRange;
+
+    // One published float mapped onto its own recent range (AnalysisConfig::normalizeFields)
+    struct NormalizedValue {
+        const float* source;   // Raw graph output
+        float* target;
+        QuantileRange range;
+    };
+    std::vector<NormalizedValue> normalizedValues;
+
+    void normalizeValue(float& value, float minValue = 0.0f, float maxValue = 1.0f);
+
+public:
+    // inputRate is the rate samples are pushed at; 0 means config.sampleRate.
+    // Throws std::runtime_error if config.features names an unknown feature,
+    // config.normalizeFields names a field that is not a computed measurement
+    // or config.fingerprintIndex cannot be used.
+    explicit AnalysisPipeline(const AnalysisConfig& config = AnalysisConfig(), unsigned int inputRate = 0);
+
+    // Resamples and buffers as many samples as fit and returns how many were taken. Callers
+    // with more input run processHop() until it returns false, then push again.
+    size_t pushSamples(const std::int16_t* samples, size_t count);
+
+    // Analyses the next hop if enough samples are buffered. Returns false otherwise.
+    bool processHop();
+
+    void reset();
+
+    const FeatureSnapshot& getSnapshot() const { return snapshot; }
+
+    // The latest snapshot with every pulse since the previous call folded in,
+    // for callers that publish once per batch of hops: each pulse field holds
+    // its strongest value and its delay field is measured to the latest hop
+    const FeatureSnapshot& collectSnapshot();
+    size_t getFrameSize() const { return frameSize; }
+    size_t getHopSize() const { return hopSize; }
+    size_t getSampleRate() const { return sampleRate; }
+    const FeatureGraph& getGraph() const { return graph; }
+
+    // Input a run needs before its output matches that of a run started
+    // earlier: seconds of preroll, and the hop multiple it must start on
+    double getSettleSeconds() const;
+    size_t getAlignmentHops() const;
+};
+
+#endif // ANALYSIS_PIPELINE_HPP
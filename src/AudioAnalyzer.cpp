@@ -1,6 +1,4 @@
 // AudioAnalyzer.cpp
-#define _USE_MATH_DEFINES
-
 #include "AudioAnalyzer.hpp"
 #include "MessageBox.hpp"
 #include <sstream>
@@ -8,18 +6,55 @@
 #include <numeric>
 #include <cmath>
 #include <cassert>
+#include <stdexcept>
 
-AudioAnalyzer::AudioAnalyzer()
-    : currentVolume(0.0f)
-    , currentCentroid(0.0f)
-    , volumeSmoothing(0.2f)
-    , centroidSmoothing(0.2f)
+AudioAnalyzer::AudioAnalyzer(const AnalysisConfig& config)
+    : config(config)
+    , usingPrecomputed(false)
+    , noSamplesWarningShown(false)
 {
-    samples.reserve(BUFFER_SIZE);
-    spectrum.resize(BUFFER_SIZE / 2, 0.0f);
+    for (const InputConfig& input : config.getInputs()) {
+        inputs.push_back(std::make_unique<InputAnalyzer>(InputSource::create(input), config, bus));
+    }
+    combined.resize(bus.getChannelCount());
+
+    if (!config.fingerprintIndex.empty()) {
+        // The pipeline has already validated the index, so this only fails on I/O errors
+        std::string error;
+        precomputed = std::make_unique<PrecomputedAnalysis>();
+        if (!precomputed->open(config.fingerprintIndex, error)) {
+            throw std::runtime_error(error);
+        }
+    }
+}
+
+AudioAnalyzer::~AudioAnalyzer() {
+    stop();
 }
 
 bool AudioAnalyzer::start() {
+    bool usesDevice = false;
+    for (const InputConfig& input : config.getInputs()) {
+        usesDevice = usesDevice || input.kind == InputKind::Device;
+    }
+    if (usesDevice && !checkAudioAvailability()) {
+        return false;
+    }
+
+    for (auto& input : inputs) {
+        std::string error;
+        if (!input->start(error)) {
+            stop();
+            MessageBox errorBox(error);
+            errorBox.show();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool AudioAnalyzer::checkAudioAvailability() {
     // Get available devices
     std::vector<std::string> availableDevices = sf::SoundRecorder::getAvailableDevices();
 
@@ -56,135 +91,26 @@ bool AudioAnalyzer::start() {
     MessageBox deviceBox(deviceInfo.str());
     deviceBox.show();
 
-    // Try to set up the audio device
-    if (!recorder.setDevice(sf::SoundRecorder::getDefaultDevice())) {
-        MessageBox errorBox("Failed to set up the audio device.\n"
-            "Please check your audio settings.");
-        errorBox.show();
-        return false;
-    }
-
-    // Start the recorder
-    if (!recorder.start()) {
-        MessageBox errorBox("Failed to start audio recorder.\n"
-            "Please check your microphone permissions.");
-        errorBox.show();
-        return false;
-    }
-
     return true;
 }
 
 void AudioAnalyzer::stop() {
-    recorder.stop();
+    for (auto& input : inputs) {
+        input->stop();
+    }
 }
 
 void AudioAnalyzer::update() {
-    const sf::SoundBuffer& buffer = recorder.getBuffer();
-    const sf::Int16* bufferSamples = buffer.getSamples();
-    size_t sampleCount = buffer.getSampleCount();
-
-    // Handle no samples case
-    if (sampleCount == 0) {
-        static bool noSamplesWarningShown = false;
-        if (!noSamplesWarningShown) {
-            MessageBox warningBox("No audio samples being received.\nPlease check if audio is playing and system permissions are correct.");
+    bus.readAll(combined);
+    usingPrecomputed = precomputed && precomputed->resolve(combined.front(), precomputedSnapshot);
+
+    // Handle no samples case; capture delivers in chunks, so only warn after a sustained gap
+    for (const auto& input : inputs) {
+        if (!noSamplesWarningShown && input->getTimeSinceSamples() > std::chrono::seconds(2)) {
+            MessageBox warningBox("No audio samples being received on input '" + input->getLabel() + "'.\n"
+                "Please check if audio is playing and system permissions are correct.");
             warningBox.show();
             noSamplesWarningShown = true;
         }
-        samples.clear();
-        samples.resize(BUFFER_SIZE, 0);  // Fill with silence
-        return;
     }
-
-    // Safely copy samples
-    samples.clear();
-    samples.resize(BUFFER_SIZE, 0);  // Initialize with zeros
-
-    size_t copyCount = std::min(sampleCount, BUFFER_SIZE);
-    size_t startPos = (sampleCount > BUFFER_SIZE) ? (sampleCount - BUFFER_SIZE) : 0;
-
-    for (size_t i = 0; i < copyCount; ++i) {
-        if (startPos + i < sampleCount) {  // Extra safety check
-            samples[i] = bufferSamples[startPos + i];
-        }
-    }
-
-    // Calculate audio features
-    float targetVolume = calculateRMS();
-    calculateSpectrum();
-    float targetCentroid = calculateSpectralCentroid();
-
-    // Smooth and normalize values
-    currentVolume = smoothValue(currentVolume, targetVolume, volumeSmoothing);
-    currentCentroid = smoothValue(currentCentroid, targetCentroid, centroidSmoothing);
-
-    normalizeValue(currentVolume);
-    normalizeValue(currentCentroid);
-}
-
-void AudioAnalyzer::calculateSpectrum() {
-    // Reset spectrum
-    spectrum.clear();
-    spectrum.resize(BUFFER_SIZE / 2, 0.0f);
-
-    // Create and fill complex input array
-    std::vector<std::complex<float>> complex_input(BUFFER_SIZE);
-    for (size_t i = 0; i < BUFFER_SIZE && i < samples.size(); ++i) {
-        // Apply Hanning window while converting to complex
-        float multiplier = 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (BUFFER_SIZE - 1)));
-        complex_input[i] = std::complex<float>((samples[i] / 32768.0f) * multiplier, 0.0f);
-    }
-
-    // Simple spectral magnitude calculation (placeholder for FFT)
-    // In a real application, you'd want to use a proper FFT library
-    for (size_t i = 0; i < BUFFER_SIZE / 2 && i < spectrum.size(); ++i) {
-        float frequency = static_cast<float>(i) * SAMPLE_RATE / BUFFER_SIZE;
-        float magnitude = std::abs(complex_input[i]);
-        spectrum[i] = magnitude;
-    }
-}
-
-float AudioAnalyzer::calculateSpectralCentroid() {
-    if (spectrum.empty()) {
-        return 0.0f;
-    }
-
-    float numerator = 0.0f;
-    float denominator = 0.0f;
-
-    for (size_t i = 0; i < spectrum.size(); ++i) {
-        float frequency = static_cast<float>(i) * SAMPLE_RATE / (2.0f * spectrum.size());
-        numerator += frequency * spectrum[i];
-        denominator += spectrum[i];
-    }
-
-    if (denominator > 0.0f) {
-        return numerator / denominator;
-    }
-    return 0.0f;
-}
-
-float AudioAnalyzer::calculateRMS() {
-    if (samples.empty()) {
-        return 0.0f;
-    }
-
-    double sum = 0.0;  // Using double for better precision in accumulation
-    for (const auto& sample : samples) {
-        float normalized = sample / 32768.0f;  // Normalize 16-bit audio
-        sum += normalized * normalized;
-    }
-
-    return static_cast<float>(std::sqrt(sum / samples.size()));
 }
-
-void AudioAnalyzer::normalizeValue(float& value, float minValue, float maxValue) {
-    value = std::clamp(value, minValue, maxValue);
-    value = (value - minValue) / (maxValue - minValue);
-}
-
-float AudioAnalyzer::smoothValue(float current, float target, float smoothing) {
-    smoothing = std::clamp(smoothing, 0.0f, 1.0f);
-    return current + smoothing * (target - current);
-}
\ No newline at end of file
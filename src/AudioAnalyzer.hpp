@@ -2,50 +2,57 @@
 #ifndef AUDIO_ANALYZER_HPP
 #define AUDIO_ANALYZER_HPP
 
+#include "AnalysisConfig.hpp"
+#include "FeatureBus.hpp"
+#include "InputAnalyzer.hpp"
+#include "PrecomputedAnalysis.hpp"
 #include <SFML/Audio.hpp>
+#include <memory>
 #include <vector>
-#include <complex>
 #include <string>
 
+// Live analysis of every configured input. Each input is analysed on its own
+// thread (see InputAnalyzer); update() collects the latest results of all
+// channels into one combined snapshot for the lighting side.
 class AudioAnalyzer {
 private:
-    static const size_t SAMPLE_RATE = 44100;
-    static const size_t BUFFER_SIZE = 1024;  // Reduced for testing
+    AnalysisConfig config;
+    FeatureBus bus;
+    std::vector<std::unique_ptr<InputAnalyzer>> inputs;
 
-    sf::SoundBufferRecorder recorder;
-    std::vector<sf::Int16> samples;
-    std::vector<float> spectrum;
+    // Latest snapshot of every channel, in bus order; the first is the primary channel
+    std::vector<FeatureSnapshot> combined;
 
-    // Audio analysis parameters
-    float currentVolume;
-    float currentCentroid;
+    // Offline analysis of the track the primary channel is recognised as, if any
+    std::unique_ptr<PrecomputedAnalysis> precomputed;
+    FeatureSnapshot precomputedSnapshot;
+    bool usingPrecomputed;
 
-    // Helper functions
-    void calculateSpectrum();
-    float calculateSpectralCentroid();
-    float calculateRMS();
-    void normalizeValue(float& value, float minValue = 0.0f, float maxValue = 1.0f);
-
-    // Smoothing parameters
-    float volumeSmoothing;
-    float centroidSmoothing;
-    float smoothValue(float current, float target, float smoothing);
+    bool noSamplesWarningShown;
 
     // Debug functions
-    void printAudioDevices();
     bool checkAudioAvailability();
-    bool setupAudioDevice(const std::string& deviceName = "");
 
 public:
-    AudioAnalyzer();
+    explicit AudioAnalyzer(const AnalysisConfig& config = AnalysisConfig());
+    ~AudioAnalyzer();
 
     bool start();
     void stop();
     void update();
 
-    // Getters for normalized values (0.0 to 1.0)
-    float getVolume() const { return currentVolume; }
-    float getSpectralCentroid() const { return currentCentroid; }
+    // Getters for normalized values (0.0 to 1.0) of the primary channel
+    float getVolume() const { return getSnapshot().volume; }
+    float getSpectralCentroid() const { return getSnapshot().centroid; }
+
+    // Everything the most recent hop of the primary channel produced, or the
+    // pre-analysed features of the recognised track at the current position
+    const FeatureSnapshot& getSnapshot() const { return usingPrecomputed ? precomputedSnapshot : combined.front(); }
+    bool isUsingPrecomputed() const { return usingPrecomputed; }
+
+    // All channels, labelled by getChannelLabels()
+    const std::vector<FeatureSnapshot>& getCombinedSnapshot() const { return combined; }
+    const std::vector<std::string>& getChannelLabels() const { return bus.getLabels(); }
 };
 
-#endif // AUDIO_ANALYZER_HPP
\ No newline at end of file
+#endif // AUDIO_ANALYZER_HPP
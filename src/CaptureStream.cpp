@@ -0,0 +1,19 @@
+// CaptureStream.cpp
+#include "CaptureStream.hpp"
+
+CaptureStream::CaptureStream(SampleQueue& queue)
+    : queue(queue)
+{
+    // Deliver chunks often enough for hop-rate analysis
+    setProcessingInterval(sf::milliseconds(10));
+}
+
+CaptureStream::~CaptureStream() {
+    // The capture thread calls onProcessSamples, so it must stop before the queue goes away
+    stop();
+}
+
+bool CaptureStream::onProcessSamples(const sf::Int16* samples, std::size_t sampleCount) {
+    queue.push(samples, sampleCount);
+    return true;
+}
@@ -0,0 +1,23 @@
+// CaptureStream.hpp
+#ifndef CAPTURE_STREAM_HPP
+#define CAPTURE_STREAM_HPP
+
+#include "SampleQueue.hpp"
+#include <SFML/Audio.hpp>
+
+// Recorder that hands every captured chunk to the analysis thread.
+// sf::SoundBufferRecorder only exposes its buffer after stop(), so live
+// analysis needs its own queue of incoming samples.
+class CaptureStream : public sf::SoundRecorder {
+private:
+    SampleQueue& queue;
+
+protected:
+    bool onProcessSamples(const sf::Int16* samples, std::size_t sampleCount) override;
+
+public:
+    explicit CaptureStream(SampleQueue& queue);
+    ~CaptureStream();
+};
+
+#endif // CAPTURE_STREAM_HPP
@@ -0,0 +1,39 @@
+// ColorConversion.cpp
+#include "ColorConversion.hpp"
+#include <algorithm>
+
+namespace {
+    double clamp01(double value) {
+        return std::max(0.0, std::min(value, 1.0));
+    }
+}
+
+RGBColor HSVtoRGB(double hue, double saturation, double value) {
+    hue = clamp01(hue);
+    saturation = clamp01(saturation);
+    value = clamp01(value);
+
+    double h = hue * 6.0;
+    int i = static_cast<int>(h);
+    double f = h - i;
+    double p = value * (1.0 - saturation);
+    double q = value * (1.0 - saturation * f);
+    double t = value * (1.0 - saturation * (1.0 - f));
+
+    double r, g, b;
+    switch (i % 6) {
+    case 0: r = value; g = t; b = p; break;
+    case 1: r = q; g = value; b = p; break;
+    case 2: r = p; g = value; b = t; break;
+    case 3: r = p; g = q; b = value; break;
+    case 4: r = t; g = p; b = value; break;
+    case 5: r = value; g = p; b = q; break;
+    default: r = 0; g = 0; b = 0; break;
+    }
+
+    return RGBColor{
+        static_cast<std::uint8_t>(r * 255),
+        static_cast<std::uint8_t>(g * 255),
+        static_cast<std::uint8_t>(b * 255)
+    };
+}
@@ -0,0 +1,17 @@
+// ColorConversion.hpp
+#ifndef COLOR_CONVERSION_HPP
+#define COLOR_CONVERSION_HPP
+
+#include <cstdint>
+
+// Plain 8-bit colour, independent of SFML so lighting output can be computed headless
+struct RGBColor {
+    std::uint8_t r;
+    std::uint8_t g;
+    std::uint8_t b;
+};
+
+// Convert HSV (each component 0-1, clamped) to 8-bit RGB
+RGBColor HSVtoRGB(double hue, double saturation, double value);
+
+#endif // COLOR_CONVERSION_HPP
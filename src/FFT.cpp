@@ -0,0 +1,140 @@
+// FFT.cpp
+#define _USE_MATH_DEFINES
+
+#include "FFT.hpp"
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+// Plain complex product; std::complex operator* adds NaN/inf recovery that
+// the compiler cannot drop without fast-math
+inline std::complex<float> multiply(std::complex<float> a, std::complex<float> b) {
+    return std::complex<float>(a.real() * b.real() - a.imag() * b.imag(),
+                               a.real() * b.imag() + a.imag() * b.real());
+}
+
+} // namespace
+
+FFT::FFT(size_t size)
+    : size(size)
+    , half(size / 2)
+{
+    if (size < 4 || (size & (size - 1)) != 0) {
+        throw std::invalid_argument("FFT size must be a power of two of at least 4");
+    }
+
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < half) {
+        ++bits;
+    }
+    bitReverse.resize(half);
+    for (size_t i = 0; i < half; ++i) {
+        size_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReverse[i] = reversed;
+    }
+
+    twiddles.resize(half / 2);
+    for (size_t k = 0; k < half / 2; ++k) {
+        double angle = -2.0 * M_PI * k / half;
+        twiddles[k] = std::complex<float>(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+
+    splitTwiddles.resize(half + 1);
+    for (size_t k = 0; k <= half; ++k) {
+        double angle = -2.0 * M_PI * k / size;
+        splitTwiddles[k] = std::complex<float>(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+}
+
+void FFT::transform(std::complex<float>* data) const {
+    for (size_t i = 0; i < half; ++i) {
+        size_t j = bitReverse[i];
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+
+    for (size_t length = 2; length <= half; length *= 2) {
+        size_t step = half / length;
+        size_t span = length / 2;
+        for (size_t start = 0; start < half; start += length) {
+            for (size_t k = 0; k < span; ++k) {
+                std::complex<float> odd = multiply(data[start + k + span], twiddles[k * step]);
+                data[start + k + span] = data[start + k] - odd;
+                data[start + k] += odd;
+            }
+        }
+    }
+}
+
+void FFT::forwardReal(const float* input, std::complex<float>* output) const {
+    // Pack even samples as real and odd samples as imaginary parts
+    for (size_t n = 0; n < half; ++n) {
+        output[n] = std::complex<float>(input[2 * n], input[2 * n + 1]);
+    }
+    transform(output);
+
+    // Split the packed transform into the spectrum of the real signal,
+    // working inwards from both ends so it can be done in place
+    std::complex<float> z0 = output[0];
+    output[0] = std::complex<float>(z0.real() + z0.imag(), 0.0f);
+    output[half] = std::complex<float>(z0.real() - z0.imag(), 0.0f);
+
+    for (size_t k = 1; k <= half / 2; ++k) {
+        size_t m = half - k;
+        std::complex<float> zk = output[k];
+        std::complex<float> zm = output[m];
+
+        std::complex<float> evenK = 0.5f * (zk + std::conj(zm));
+        std::complex<float> diffK = zk - std::conj(zm);
+        std::complex<float> oddK(0.5f * diffK.imag(), -0.5f * diffK.real());   // -i/2 * diff
+        std::complex<float> evenM = 0.5f * (zm + std::conj(zk));
+        std::complex<float> diffM = zm - std::conj(zk);
+        std::complex<float> oddM(0.5f * diffM.imag(), -0.5f * diffM.real());
+
+        output[k] = evenK + multiply(splitTwiddles[k], oddK);
+        output[m] = evenM + multiply(splitTwiddles[m], oddM);
+    }
+}
+
+void FFT::inverseReal(const std::complex<float>* input, float* output) const {
+    // Rebuild the packed transform Z = E + iO from the real spectrum, with
+    // E and O the spectra of the even and odd samples. It is stored
+    // conjugated, so the forward transform computes the inverse one.
+    std::complex<float>* packed = reinterpret_cast<std::complex<float>*>(output);
+    for (size_t k = 0; k < half; ++k) {
+        std::complex<float> xk = input[k];
+        std::complex<float> xm = std::conj(input[half - k]);
+        std::complex<float> even = 0.5f * (xk + xm);
+        std::complex<float> odd = multiply(0.5f * (xk - xm), std::conj(splitTwiddles[k]));
+        packed[k] = std::complex<float>(even.real() - odd.imag(), -(even.imag() + odd.real()));
+    }
+    transform(packed);
+
+    // Conjugate back and scale; even samples land in the real parts and odd
+    // samples in the imaginary parts, which is already the output order
+    float scale = 1.0f / half;
+    for (size_t n = 0; n < half; ++n) {
+        output[2 * n] *= scale;
+        output[2 * n + 1] *= -scale;
+    }
+}
+
+std::shared_ptr<const FFT> FFT::getPlan(size_t size) {
+    static std::mutex mutex;
+    static std::map<size_t, std::weak_ptr<const FFT>> plans;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const FFT> plan = plans[size].lock();
+    if (!plan) {
+        plan = std::make_shared<const FFT>(size);
+        plans[size] = plan;
+    }
+    return plan;
+}
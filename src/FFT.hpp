@@ -0,0 +1,41 @@
+// FFT.hpp
+#ifndef FFT_HPP
+#define FFT_HPP
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Precomputed plan for a power-of-two real-input FFT. The N real samples are
+// packed into an N/2-point complex transform (iterative radix-2) and split
+// afterwards, so one plan costs roughly half of a full complex FFT. All
+// tables are built in the constructor; transforms never allocate.
+class FFT {
+private:
+    size_t size;        // N, real samples
+    size_t half;        // N/2, complex transform length
+
+    std::vector<size_t> bitReverse;
+    std::vector<std::complex<float>> twiddles;       // exp(-2 pi i k / half), k < half/2
+    std::vector<std::complex<float>> splitTwiddles;  // exp(-2 pi i k / size), k <= half
+
+    void transform(std::complex<float>* data) const;
+
+public:
+    explicit FFT(size_t size);
+
+    // output receives bins 0..N/2 (N/2 + 1 values)
+    void forwardReal(const float* input, std::complex<float>* output) const;
+    // Inverse of forwardReal, scaled so inverseReal(forwardReal(x)) == x.
+    // input holds bins 0..N/2 and must not overlap output (N samples).
+    void inverseReal(const std::complex<float>* input, float* output) const;
+
+    // Shared plan for a size, built on first use. Plans are read-only once
+    // built, so every node and channel wanting the same size can share one.
+    static std::shared_ptr<const FFT> getPlan(size_t size);
+
+    size_t getSize() const { return size; }
+};
+
+#endif // FFT_HPP
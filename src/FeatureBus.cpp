@@ -0,0 +1,21 @@
+// FeatureBus.cpp
+#include "FeatureBus.hpp"
+#include <algorithm>
+
+size_t FeatureBus::addChannel(const std::string& label) {
+    std::lock_guard<std::mutex> lock(mutex);
+    labels.push_back(label);
+    snapshots.emplace_back();
+    return labels.size() - 1;
+}
+
+void FeatureBus::publish(size_t slot, const FeatureSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    snapshots[slot] = snapshot;
+}
+
+void FeatureBus::readAll(std::vector<FeatureSnapshot>& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.resize(snapshots.size());
+    std::copy(snapshots.begin(), snapshots.end(), out.begin());
+}
@@ -0,0 +1,32 @@
+// FeatureBus.hpp
+#ifndef FEATURE_BUS_HPP
+#define FEATURE_BUS_HPP
+
+#include "FeatureSnapshot.hpp"
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Combined feature snapshot of every analysed channel. Each input thread
+// publishes into its own slots; the lighting side copies the whole set out
+// once per frame. Slots are registered up front, before any thread starts.
+class FeatureBus {
+private:
+    mutable std::mutex mutex;
+    std::vector<std::string> labels;
+    std::vector<FeatureSnapshot> snapshots;
+
+public:
+    // Setup only: reserves a slot and returns its index
+    size_t addChannel(const std::string& label);
+
+    void publish(size_t slot, const FeatureSnapshot& snapshot);
+
+    // Copies all channels into out, which is resized to getChannelCount()
+    void readAll(std::vector<FeatureSnapshot>& out) const;
+
+    size_t getChannelCount() const { return labels.size(); }
+    const std::vector<std::string>& getLabels() const { return labels; }
+};
+
+#endif // FEATURE_BUS_HPP
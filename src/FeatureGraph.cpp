@@ -0,0 +1,194 @@
+// FeatureGraph.cpp
+#include "FeatureGraph.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+// Output slots start on a cache line so SIMD kernels see aligned data
+const size_t SLOT_ALIGNMENT = FrameArena::ALIGNMENT / sizeof(float);
+
+size_t alignSlot(size_t offset) {
+    return (offset + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+}
+
+} // namespace
+
+FeatureGraph::FeatureGraph(const FrameContext& context)
+    : context(context)
+    , outputs(nullptr)
+    , arena(std::make_unique<FrameArena>(0))
+    , compiled(false)
+{
+}
+
+void FeatureGraph::addNode(std::unique_ptr<FeatureNode> node) {
+    if (compiled) {
+        throw std::runtime_error("Feature graph nodes must be added before compile()");
+    }
+    if (hasNode(node->getName())) {
+        throw std::runtime_error(std::string("Duplicate feature node: ") + node->getName());
+    }
+    Slot slot;
+    slot.node = std::move(node);
+    slots.push_back(std::move(slot));
+}
+
+bool FeatureGraph::hasNode(const std::string& name) const {
+    for (const Slot& slot : slots) {
+        if (name == slot.node->getName()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+FrameResolution FeatureGraph::getResolution(const std::string& name) const {
+    for (const Slot& slot : slots) {
+        if (name == slot.node->getName()) {
+            return slot.node->getResolution();
+        }
+    }
+    return FrameResolution::Base;
+}
+
+void FeatureGraph::subscribe(const std::string& name) {
+    if (compiled) {
+        throw std::runtime_error("Feature graph subscriptions must be made before compile()");
+    }
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (name == slots[i].node->getName()) {
+            subscriptions.push_back(i);
+            return;
+        }
+    }
+    throw std::runtime_error("Unknown feature: " + name);
+}
+
+void FeatureGraph::visit(size_t index, std::vector<int>& state) {
+    // state: 0 = unvisited, 1 = on the current path, 2 = done
+    if (state[index] == 2) {
+        return;
+    }
+    if (state[index] == 1) {
+        throw std::runtime_error(std::string("Feature graph cycle through ") + slots[index].node->getName());
+    }
+    state[index] = 1;
+
+    Slot& slot = slots[index];
+    slot.inputs.clear();
+    for (const std::string& input : slot.node->getInputs()) {
+        size_t found = NO_NODE;
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (input == slots[i].node->getName()) {
+                found = i;
+                break;
+            }
+        }
+        if (found == NO_NODE) {
+            throw std::runtime_error("Feature " + std::string(slot.node->getName()) + " needs unknown input " + input);
+        }
+        visit(found, state);
+        slot.inputs.push_back(found);
+    }
+
+    // Dependencies are scheduled first, so post-order is a topological order
+    state[index] = 2;
+    slot.scheduled = true;
+    schedule.push_back(index);
+}
+
+void FeatureGraph::compile() {
+    if (compiled) {
+        return;
+    }
+
+    std::vector<int> state(slots.size(), 0);
+    for (size_t index : subscriptions) {
+        visit(index, state);
+    }
+
+    size_t totalFloats = 0;
+    size_t scratchBytes = 0;
+    size_t edgeCount = 0;
+    for (size_t index : schedule) {
+        Slot& slot = slots[index];
+        std::vector<size_t> inputSizes;
+        for (size_t input : slot.inputs) {
+            inputSizes.push_back(slots[input].size);
+        }
+        slot.size = slot.node->prepare(context, inputSizes);
+        slot.offset = alignSlot(totalFloats);
+        totalFloats = slot.offset + slot.size;
+        // Each node's region is padded so its allocations can be realigned
+        size_t nodeScratch = slot.node->getScratchBytes();
+        scratchBytes += nodeScratch ? nodeScratch + FrameArena::ALIGNMENT : 0;
+        edgeCount += slot.inputs.size();
+    }
+
+    // Slot offsets are aligned relative to an aligned base
+    outputStorage.assign(totalFloats + SLOT_ALIGNMENT, 0.0f);
+    size_t misalignment = reinterpret_cast<std::uintptr_t>(outputStorage.data()) % FrameArena::ALIGNMENT;
+    outputs = outputStorage.data() + (misalignment ? (FrameArena::ALIGNMENT - misalignment) / sizeof(float) : 0);
+    arena = std::make_unique<FrameArena>(scratchBytes);
+
+    inputViews.resize(edgeCount);
+    inputViewStart.resize(schedule.size());
+    size_t edge = 0;
+    for (size_t s = 0; s < schedule.size(); ++s) {
+        inputViewStart[s] = edge;
+        for (size_t input : slots[schedule[s]].inputs) {
+            inputViews[edge++] = std::span<const float>(outputs + slots[input].offset, slots[input].size);
+        }
+    }
+
+    compiled = true;
+}
+
+void FeatureGraph::process(const std::int16_t* frame) {
+    arena->reset();
+    for (size_t s = 0; s < schedule.size(); ++s) {
+        Slot& slot = slots[schedule[s]];
+        NodeInputs inputs{ frame, inputViews.data() + inputViewStart[s], slot.inputs.size() };
+        slot.node->process(inputs, std::span<float>(outputs + slot.offset, slot.size), *arena);
+    }
+}
+
+void FeatureGraph::reset() {
+    std::fill(outputStorage.begin(), outputStorage.end(), 0.0f);
+    for (size_t index : schedule) {
+        slots[index].node->reset();
+    }
+}
+
+size_t FeatureGraph::findScheduled(const std::string& name) const {
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (slots[i].scheduled && name == slots[i].node->getName()) {
+            return i;
+        }
+    }
+    return NO_NODE;
+}
+
+double FeatureGraph::getSettleSeconds() const {
+    double seconds = 0.0;
+    for (size_t index : schedule) {
+        seconds = std::max(seconds, slots[index].node->getSettleSeconds());
+    }
+    return seconds;
+}
+
+size_t FeatureGraph::getBlockFrames() const {
+    size_t frames = 1;
+    for (size_t index : schedule) {
+        frames = std::lcm(frames, slots[index].node->getBlockFrames());
+    }
+    return frames;
+}
+
+std::span<const float> FeatureGraph::getOutput(size_t index) const {
+    const Slot& slot = slots[index];
+    return std::span<const float>(outputs + slot.offset, slot.size);
+}
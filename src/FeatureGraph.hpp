@@ -0,0 +1,138 @@
+// FeatureGraph.hpp
+#ifndef FEATURE_GRAPH_HPP
+#define FEATURE_GRAPH_HPP
+
+#include "AnalysisConfig.hpp"
+#include "FrameArena.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Frame lengths a node can ask for. The pipeline runs Tonal nodes in a
+// second graph with long frames (AnalysisConfig::tonalFrameSize) when one is
+// configured, and with everything else otherwise.
+enum class FrameResolution {
+    Base,    // frame_size / hop_size: short frames, every hop
+    Tonal    // Long frames for pitch, every few hops
+};
+
+// Fixed per-graph analysis parameters handed to every node
+struct FrameContext {
+    size_t frameSize = 1024;
+    size_t hopSize = 512;
+    unsigned int sampleRate = 44100;
+    WindowType window = WindowType::Hann;
+    bool genericKernels = false;   // Force the run-time sized kernels (benchmarking)
+    float noiseSubtraction = 0.0f; // Noise floors taken off rms and magnitude, 0 = off
+    float noiseFloorSeconds = 300.0f;
+};
+
+// What a node sees when it runs: the raw frame plus the outputs of the
+// nodes it declared as inputs, in declaration order
+struct NodeInputs {
+    const std::int16_t* samples;
+    const std::span<const float>* inputs;
+    size_t count;
+
+    std::span<const float> operator[](size_t index) const { return inputs[index]; }
+};
+
+// One step of frame analysis. Nodes name their inputs; the graph resolves
+// the names, orders the nodes and owns every output slot. prepare() runs once
+// when the graph is compiled and is the only place a node may allocate.
+class FeatureNode {
+public:
+    virtual ~FeatureNode() = default;
+
+    virtual const char* getName() const = 0;
+    virtual std::vector<std::string> getInputs() const { return {}; }
+    virtual FrameResolution getResolution() const { return FrameResolution::Base; }
+
+    // Called once, after the inputs are resolved; returns the output size in floats
+    virtual size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) = 0;
+
+    // Arena bytes process() may take per frame
+    virtual size_t getScratchBytes() const { return 0; }
+
+    virtual void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) = 0;
+
+    // Clears any state carried between frames
+    virtual void reset() {}
+
+    // Seconds of input the output still depends on: a run started this long
+    // before a frame gives the same output there as one started earlier.
+    // 0 for nodes that forget within a few frames.
+    virtual double getSettleSeconds() const { return 0.0; }
+
+    // Frames per block the node's state is kept in, counted from the first
+    // frame; runs only line up if they start a whole number of blocks apart
+    virtual size_t getBlockFrames() const { return 1; }
+};
+
+// Declarative per-frame feature extraction. Nodes are added by name, consumers
+// subscribe to the features they need, and compile() schedules only the
+// subscribed nodes and their dependencies (in topological order) into one
+// preallocated block of output slots. Each intermediate is computed once per
+// frame however many nodes read it, and unsubscribed features cost nothing.
+class FeatureGraph {
+private:
+    struct Slot {
+        std::unique_ptr<FeatureNode> node;
+        std::vector<size_t> inputs;   // Slot indices
+        size_t offset = 0;            // Into outputs
+        size_t size = 0;
+        bool scheduled = false;
+    };
+
+    FrameContext context;
+    std::vector<Slot> slots;
+    std::vector<size_t> subscriptions;
+    std::vector<size_t> schedule;
+    std::vector<std::span<const float>> inputViews;   // Per scheduled input edge
+    std::vector<size_t> inputViewStart;                // Per schedule entry
+    std::vector<float> outputStorage;                  // Padded by one cache line
+    float* outputs;                                    // Cache-line aligned start of outputStorage
+    std::unique_ptr<FrameArena> arena;
+    bool compiled;
+
+    void visit(size_t index, std::vector<int>& state);
+
+public:
+    explicit FeatureGraph(const FrameContext& context);
+
+    // Nodes must be added before compile(); names are unique
+    void addNode(std::unique_ptr<FeatureNode> node);
+    bool hasNode(const std::string& name) const;
+    // Resolution a node asks for; Base for unknown names
+    FrameResolution getResolution(const std::string& name) const;
+
+    // Marks a feature (and everything it depends on) for evaluation
+    void subscribe(const std::string& name);
+
+    // Resolves inputs, orders the subscribed closure and sizes every buffer.
+    // Throws std::runtime_error for unknown names or dependency cycles.
+    void compile();
+
+    // Runs the schedule on one frame of frameSize samples. Never allocates.
+    void process(const std::int16_t* frame);
+
+    void reset();
+
+    // Slot index for a node, or NO_NODE if it is unknown or not scheduled
+    static const size_t NO_NODE = static_cast<size_t>(-1);
+    size_t findScheduled(const std::string& name) const;
+    std::span<const float> getOutput(size_t index) const;
+
+    // Longest settle time and the common block length of the scheduled nodes
+    double getSettleSeconds() const;
+    size_t getBlockFrames() const;
+
+    const FrameContext& getContext() const { return context; }
+    size_t getScheduledCount() const { return schedule.size(); }
+    bool isCompiled() const { return compiled; }
+};
+
+#endif // FEATURE_GRAPH_HPP
@@ -0,0 +1,465 @@
+// FeatureNodes.cpp
+#define _USE_MATH_DEFINES
+
+#include "FeatureNodes.hpp"
+#include "HarmonyNodes.hpp"
+#include "PercussionNodes.hpp"
+#include "StructureNodes.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define FEATURE_NODES_USE_SSE 1
+#endif
+
+namespace {
+
+FrameKernelTable kernelsFor(const FrameContext& context) {
+    return context.genericKernels ? makeFrameKernelTable<0>() : selectFrameKernels(context.frameSize);
+}
+
+float hzToMel(float hz) {
+    return 2595.0f * std::log10(1.0f + hz / 700.0f);
+}
+
+float melToHz(float mel) {
+    return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+} // namespace
+
+const float RmsNode::LEVEL_FLOOR = 0.1f;   // -20 dB, as for the spectrum
+const double LoudnessNode::MOMENTARY_SECONDS = 0.4;
+const double LoudnessNode::SHORT_TERM_SECONDS = 3.0;
+const float LoudnessNode::MIN_LOUDNESS = -70.0f;   // The R128 absolute gate; silence reads as this
+const float NoiseFloorNode::BIN_BIAS_SCALE = 3.5f;   // Both fitted to white noise
+const float NoiseFloorNode::LEVEL_BIAS = 1.05f;
+const float MagnitudeNode::SPECTRAL_FLOOR = 0.1f;   // -20 dB
+const float MelBandsNode::MIN_FREQUENCY = 40.0f;
+const float MelBandsNode::MAX_FREQUENCY = 16000.0f;
+const float FluxNode::LOG_COMPRESSION = 1.0f;
+const float OnsetNode::HISTORY_SECONDS = 0.5f;
+const float OnsetNode::REFRACTORY_SECONDS = 0.05f;
+const float OnsetNode::SENSITIVITY = 1.5f;
+const float OnsetNode::MIN_FLUX = 1e-3f;
+
+std::vector<std::string> RmsNode::getInputs() const {
+    return denoise ? std::vector<std::string>{ "noise_floor" } : std::vector<std::string>{};
+}
+
+size_t RmsNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    kernels = kernelsFor(context);
+    frameSize = context.frameSize;
+    subtraction = context.noiseSubtraction;
+    return 1;
+}
+
+void RmsNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    float rms = kernels.rms(inputs.samples, frameSize);
+    if (denoise) {
+        float noise = inputs[0].back();
+        rms = std::max(std::sqrt(std::max(0.0f, rms * rms - subtraction * noise)), LEVEL_FLOOR * rms);
+    }
+    output[0] = rms;
+}
+
+size_t LoudnessNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    frameSize = context.frameSize;
+    hopSize = context.hopSize;
+
+    // BS.1770 K-weighting, designed for the analysis rate (the published
+    // 48 kHz coefficients come out of the same formulas)
+    double rate = context.sampleRate;
+    double k = std::tan(M_PI * 1681.974450955533 / rate);
+    double q = 0.7071752369554196;
+    double vh = std::pow(10.0, 3.999843853973347 / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    shelf = { (vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0,
+              2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0 };
+
+    k = std::tan(M_PI * 38.13547087602444 / rate);
+    q = 0.5003270373238773;
+    a0 = 1.0 + k / q + k * k;
+    highPass = { 1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0 };
+
+    double hopSeconds = static_cast<double>(hopSize) / context.sampleRate;
+    size_t shortTermHops = std::max<size_t>(1, static_cast<size_t>(std::lround(SHORT_TERM_SECONDS / hopSeconds)));
+    momentaryHops = std::clamp<size_t>(static_cast<size_t>(std::lround(MOMENTARY_SECONDS / hopSeconds)), 1, shortTermHops);
+    hopEnergy.assign(shortTermHops, 0.0);
+    reset();
+    return 2;
+}
+
+float LoudnessNode::toLoudness(double meanSquare) const {
+    if (meanSquare <= 0.0) {
+        return MIN_LOUDNESS;
+    }
+    return std::max(MIN_LOUDNESS, static_cast<float>(-0.691 + 10.0 * std::log10(meanSquare)));
+}
+
+void LoudnessNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    // Both stages run over the hop in one pass with their state in locals
+    const Biquad s = shelf;
+    const Biquad h = highPass;
+    double s1 = shelfState[0], s2 = shelfState[1];
+    double h1 = highPassState[0], h2 = highPassState[1];
+    double energy = 0.0;
+    const std::int16_t* samples = inputs.samples + frameSize - hopSize;
+    for (size_t i = 0; i < hopSize; ++i) {
+        double x = samples[i] * (1.0 / 32768.0);
+        double y = s.b0 * x + s1;
+        s1 = s.b1 * x - s.a1 * y + s2;
+        s2 = s.b2 * x - s.a2 * y;
+        double z = h.b0 * y + h1;
+        h1 = h.b1 * y - h.a1 * z + h2;
+        h2 = h.b2 * y - h.a2 * z;
+        energy += z * z;
+    }
+    shelfState[0] = s1;
+    shelfState[1] = s2;
+    highPassState[0] = h1;
+    highPassState[1] = h2;
+    energy /= static_cast<double>(hopSize);
+
+    // Slide both windows by one hop; the ring holds exactly the short-term window
+    size_t length = hopEnergy.size();
+    size_t momentaryOut = (ringPos + length - momentaryHops) % length;
+    momentarySum += energy - hopEnergy[momentaryOut];
+    shortTermSum += energy - hopEnergy[ringPos];
+    hopEnergy[ringPos] = energy;
+    ringPos = (ringPos + 1) % length;
+
+    // Rounding in the running sums can leave a tiny negative after loud passages
+    output[0] = toLoudness(std::max(0.0, momentarySum) / static_cast<double>(momentaryHops));
+    output[1] = toLoudness(std::max(0.0, shortTermSum) / static_cast<double>(length));
+}
+
+void LoudnessNode::reset() {
+    std::fill(std::begin(shelfState), std::end(shelfState), 0.0);
+    std::fill(std::begin(highPassState), std::end(highPassState), 0.0);
+    std::fill(hopEnergy.begin(), hopEnergy.end(), 0.0);
+    ringPos = 0;
+    momentarySum = 0.0;
+    shortTermSum = 0.0;
+}
+
+ToneNode::ToneNode(const std::vector<float>& frequencies, float responseSeconds)
+    : frequencies(frequencies)
+    , responseSeconds(responseSeconds)
+{
+}
+
+size_t ToneNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    frameSize = context.frameSize;
+    hopSize = context.hopSize;
+
+    // A steady sine of amplitude A settles at |X| = A / (2 (1 - r))
+    double r = std::exp(-1.0 / (responseSeconds * context.sampleRate));
+    gain = static_cast<float>(2.0 * (1.0 - r));
+
+    size_t count = frequencies.size();
+    size_t padded = (count + TONE_GROUP - 1) / TONE_GROUP * TONE_GROUP;
+    rotationRe.assign(padded, 0.0f);
+    rotationIm.assign(padded, 0.0f);
+    stateRe.assign(padded, 0.0f);
+    stateIm.assign(padded, 0.0f);
+    for (size_t k = 0; k < count; ++k) {
+        double w = 2.0 * M_PI * frequencies[k] / context.sampleRate;
+        rotationRe[k] = static_cast<float>(r * std::cos(w));
+        rotationIm[k] = static_cast<float>(r * std::sin(w));
+    }
+    return count;
+}
+
+void ToneNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    const std::int16_t* samples = inputs.samples + frameSize - hopSize;
+    size_t count = frequencies.size();
+    for (size_t group = 0; group < stateRe.size(); group += TONE_GROUP) {
+#ifdef FEATURE_NODES_USE_SSE
+        __m128 cosA = _mm_loadu_ps(rotationRe.data() + group);
+        __m128 sinA = _mm_loadu_ps(rotationIm.data() + group);
+        __m128 cosB = _mm_loadu_ps(rotationRe.data() + group + 4);
+        __m128 sinB = _mm_loadu_ps(rotationIm.data() + group + 4);
+        __m128 reA = _mm_loadu_ps(stateRe.data() + group);
+        __m128 imA = _mm_loadu_ps(stateIm.data() + group);
+        __m128 reB = _mm_loadu_ps(stateRe.data() + group + 4);
+        __m128 imB = _mm_loadu_ps(stateIm.data() + group + 4);
+        const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+        for (size_t i = 0; i < hopSize; ++i) {
+            __m128 x = _mm_mul_ps(_mm_set1_ps(static_cast<float>(samples[i])), scale);
+            __m128 nextReA = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(cosA, reA), _mm_mul_ps(sinA, imA)), x);
+            __m128 nextReB = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(cosB, reB), _mm_mul_ps(sinB, imB)), x);
+            imA = _mm_add_ps(_mm_mul_ps(sinA, reA), _mm_mul_ps(cosA, imA));
+            imB = _mm_add_ps(_mm_mul_ps(sinB, reB), _mm_mul_ps(cosB, imB));
+            reA = nextReA;
+            reB = nextReB;
+        }
+        _mm_storeu_ps(stateRe.data() + group, reA);
+        _mm_storeu_ps(stateIm.data() + group, imA);
+        _mm_storeu_ps(stateRe.data() + group + 4, reB);
+        _mm_storeu_ps(stateIm.data() + group + 4, imB);
+#else
+        for (size_t k = group; k < group + TONE_GROUP; ++k) {
+            float re = stateRe[k];
+            float im = stateIm[k];
+            for (size_t i = 0; i < hopSize; ++i) {
+                float nextRe = rotationRe[k] * re - rotationIm[k] * im + samples[i] * (1.0f / 32768.0f);
+                im = rotationIm[k] * re + rotationRe[k] * im;
+                re = nextRe;
+            }
+            stateRe[k] = re;
+            stateIm[k] = im;
+        }
+#endif
+    }
+    for (size_t k = 0; k < count; ++k) {
+        output[k] = gain * std::sqrt(stateRe[k] * stateRe[k] + stateIm[k] * stateIm[k]);
+    }
+}
+
+void ToneNode::reset() {
+    std::fill(stateRe.begin(), stateRe.end(), 0.0f);
+    std::fill(stateIm.begin(), stateIm.end(), 0.0f);
+}
+
+size_t WindowNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    kernels = kernelsFor(context);
+
+    // Window coefficients are computed once rather than per frame
+    size_t frameSize = context.frameSize;
+    window.resize(frameSize);
+    for (size_t i = 0; i < frameSize; ++i) {
+        double phase = 2.0 * M_PI * i / (frameSize - 1);
+        switch (context.window) {
+        case WindowType::Hann:        window[i] = static_cast<float>(0.5 * (1.0 - std::cos(phase))); break;
+        case WindowType::Hamming:     window[i] = static_cast<float>(0.54 - 0.46 * std::cos(phase)); break;
+        case WindowType::Blackman:    window[i] = static_cast<float>(0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase)); break;
+        case WindowType::Rectangular: window[i] = 1.0f; break;
+        }
+    }
+    return frameSize;
+}
+
+void WindowNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    kernels.window(inputs.samples, window.data(), output.data(), output.size());
+}
+
+size_t FftNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    fft = FFT::getPlan(context.frameSize);
+    return (context.frameSize / 2 + 1) * 2;
+}
+
+void FftNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    // std::complex<float> is layout-compatible with float[2]
+    fft->forwardReal(inputs[0].data(), reinterpret_cast<std::complex<float>*>(output.data()));
+}
+
+size_t NoiseFloorNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    kernels = kernelsFor(context);
+    frameSize = context.frameSize;
+    double hopSeconds = static_cast<double>(context.hopSize) / context.sampleRate;
+    // A bin's minimum sits further below its mean the fewer independent
+    // spectra (about one per frame length) the smoothing averages
+    double spectra = std::max(1.0, NoiseFloor::SMOOTHING_SECONDS * context.sampleRate / frameSize);
+    float binBias = static_cast<float>(1.0 + BIN_BIAS_SCALE / std::sqrt(spectra));
+    binFloor = std::make_unique<NoiseFloor>(frameSize / 2, hopSeconds, context.noiseFloorSeconds, binBias);
+    levelFloor = std::make_unique<NoiseFloor>(1, hopSeconds, context.noiseFloorSeconds, LEVEL_BIAS);
+    power.resize(frameSize / 2);
+    return frameSize / 2 + 1;
+}
+
+void NoiseFloorNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    const float* spectrum = inputs[0].data();
+    size_t bins = frameSize / 2;
+    for (size_t b = 0; b < bins; ++b) {
+        power[b] = spectrum[2 * b] * spectrum[2 * b] + spectrum[2 * b + 1] * spectrum[2 * b + 1];
+    }
+    binFloor->update(power.data());
+
+    float rms = kernels.rms(inputs.samples, frameSize);
+    float level = rms * rms;
+    levelFloor->update(&level);
+
+    std::copy_n(binFloor->getFloors(), bins, output.data());
+    output[bins] = levelFloor->getFloor(0);
+}
+
+void NoiseFloorNode::reset() {
+    binFloor->reset();
+    levelFloor->reset();
+}
+
+std::vector<std::string> MagnitudeNode::getInputs() const {
+    return denoise ? std::vector<std::string>{ "fft", "noise_floor" } : std::vector<std::string>{ "fft" };
+}
+
+size_t MagnitudeNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    kernels = kernelsFor(context);
+    frameSize = context.frameSize;
+    subtraction = context.noiseSubtraction;
+    return frameSize / 2;
+}
+
+void MagnitudeNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    kernels.magnitude(inputs[0].data(), output.data(), frameSize);
+    if (denoise) {
+        const float* noise = inputs[1].data();
+        for (size_t b = 0; b < frameSize / 2; ++b) {
+            float magnitude = output[b];
+            float clean = magnitude * magnitude - subtraction * noise[b];
+            output[b] = std::max(clean > 0.0f ? std::sqrt(clean) : 0.0f, SPECTRAL_FLOOR * magnitude);
+        }
+    }
+}
+
+size_t CentroidNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    kernels = kernelsFor(context);
+    frameSize = context.frameSize;
+    sampleRate = static_cast<float>(context.sampleRate);
+    return 1;
+}
+
+void CentroidNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    output[0] = kernels.centroid(inputs[0].data(), sampleRate, frameSize);
+}
+
+size_t MelBandsNode::prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) {
+    size_t bins = inputSizes[0];
+    float binWidth = static_cast<float>(context.sampleRate) / context.frameSize;
+    float maxFrequency = std::min(MAX_FREQUENCY, context.sampleRate / 2.0f);
+    float minMel = hzToMel(MIN_FREQUENCY);
+    float maxMel = hzToMel(maxFrequency);
+
+    // Band b spans edges b..b+2 and peaks at edge b+1
+    std::vector<float> edges(MEL_BAND_COUNT + 2);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        edges[i] = melToHz(minMel + (maxMel - minMel) * i / (MEL_BAND_COUNT + 1));
+    }
+
+    firstBin.assign(MEL_BAND_COUNT, 0);
+    weightStart.assign(MEL_BAND_COUNT + 1, 0);
+    weights.clear();
+    for (size_t band = 0; band < MEL_BAND_COUNT; ++band) {
+        float low = edges[band];
+        float centre = edges[band + 1];
+        float high = edges[band + 2];
+
+        size_t first = std::min(bins, static_cast<size_t>(std::ceil(low / binWidth)));
+        size_t last = std::min(bins, static_cast<size_t>(std::ceil(high / binWidth)));
+        firstBin[band] = first;
+        weightStart[band] = weights.size();
+        for (size_t bin = first; bin < last; ++bin) {
+            float frequency = bin * binWidth;
+            float weight = frequency <= centre ? (frequency - low) / (centre - low)
+                                               : (high - frequency) / (high - centre);
+            weights.push_back(std::max(0.0f, weight));
+        }
+    }
+    weightStart[MEL_BAND_COUNT] = weights.size();
+    return MEL_BAND_COUNT;
+}
+
+void MelBandsNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    const float* magnitudes = inputs[0].data();
+    for (size_t band = 0; band < MEL_BAND_COUNT; ++band) {
+        const float* bandMagnitudes = magnitudes + firstBin[band];
+        float sum = 0.0f;
+        for (size_t w = weightStart[band]; w < weightStart[band + 1]; ++w) {
+            sum += weights[w] * bandMagnitudes[w - weightStart[band]];
+        }
+        output[band] = sum;
+    }
+}
+
+size_t FluxNode::prepare(const FrameContext&, const std::vector<size_t>& inputSizes) {
+    previous.assign(inputSizes[0], 0.0f);
+    return 1;
+}
+
+void FluxNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    std::span<const float> bands = inputs[0];
+    float flux = 0.0f;
+    for (size_t i = 0; i < bands.size(); ++i) {
+        float compressed = std::log1p(LOG_COMPRESSION * bands[i]);
+        flux += std::max(0.0f, compressed - previous[i]);
+        previous[i] = compressed;
+    }
+    output[0] = flux / bands.size();
+}
+
+void FluxNode::reset() {
+    std::fill(previous.begin(), previous.end(), 0.0f);
+}
+
+size_t OnsetNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    double hopSeconds = static_cast<double>(context.hopSize) / context.sampleRate;
+    history.assign(std::max<size_t>(4, static_cast<size_t>(std::ceil(HISTORY_SECONDS / hopSeconds))), 0.0f);
+    refractoryHops = std::max<size_t>(1, static_cast<size_t>(std::ceil(REFRACTORY_SECONDS / hopSeconds)));
+    reset();
+    return 2;
+}
+
+void OnsetNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    float flux = inputs[0][0];
+
+    // Threshold from the frames before this one
+    float mean = 0.0f;
+    float variance = 0.0f;
+    if (historyFilled > 0) {
+        for (size_t i = 0; i < historyFilled; ++i) {
+            mean += history[i];
+        }
+        mean /= historyFilled;
+        for (size_t i = 0; i < historyFilled; ++i) {
+            variance += (history[i] - mean) * (history[i] - mean);
+        }
+        variance /= historyFilled;
+    }
+    float threshold = mean + SENSITIVITY * std::sqrt(variance);
+
+    float strength = std::max(0.0f, flux - threshold);
+    bool onset = strength > 0.0f && flux > MIN_FLUX && historyFilled == history.size()
+              && hopsSinceOnset >= refractoryHops;
+
+    hopsSinceOnset = onset ? 0 : hopsSinceOnset + 1;
+    history[historyPos] = flux;
+    historyPos = (historyPos + 1) % history.size();
+    historyFilled = std::min(historyFilled + 1, history.size());
+
+    output[0] = strength;
+    output[1] = onset ? 1.0f : 0.0f;
+}
+
+void OnsetNode::reset() {
+    std::fill(history.begin(), history.end(), 0.0f);
+    historyPos = 0;
+    historyFilled = 0;
+    hopsSinceOnset = refractoryHops;
+}
+
+void addStandardNodes(FeatureGraph& graph) {
+    bool denoise = graph.getContext().noiseSubtraction > 0.0f;
+    graph.addNode(std::make_unique<RmsNode>(denoise));
+    graph.addNode(std::make_unique<LoudnessNode>());
+    graph.addNode(std::make_unique<WindowNode>());
+    graph.addNode(std::make_unique<FftNode>());
+    graph.addNode(std::make_unique<NoiseFloorNode>());
+    graph.addNode(std::make_unique<MagnitudeNode>(denoise));
+    graph.addNode(std::make_unique<CentroidNode>());
+    graph.addNode(std::make_unique<MelBandsNode>());
+    graph.addNode(std::make_unique<FluxNode>());
+    graph.addNode(std::make_unique<OnsetNode>());
+    graph.addNode(std::make_unique<ChromaNode>());
+    graph.addNode(std::make_unique<KeyNode>());
+    graph.addNode(std::make_unique<ChordNode>());
+    graph.addNode(std::make_unique<PitchNode>());
+    graph.addNode(std::make_unique<HpssNode>());
+    graph.addNode(std::make_unique<HpssEnergyNode>());
+    graph.addNode(std::make_unique<DrumNode>());
+    graph.addNode(std::make_unique<CrossoverNode>());
+    graph.addNode(std::make_unique<SectionNode>());
+    graph.addNode(std::make_unique<DropNode>());
+}
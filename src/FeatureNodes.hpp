@@ -0,0 +1,258 @@
+// FeatureNodes.hpp
+#ifndef FEATURE_NODES_HPP
+#define FEATURE_NODES_HPP
+
+#include "FFT.hpp"
+#include "FeatureGraph.hpp"
+#include "FeatureSnapshot.hpp"
+#include "FrameKernels.hpp"
+#include "NoiseFloor.hpp"
+#include <memory>
+#include <vector>
+
+// Standard analysis nodes. Names are what consumers subscribe to:
+//   rms        frame RMS (raw samples, less the noise floor with noise subtraction)
+//   loudness   [momentary, short-term] K-weighted loudness in LUFS (EBU R128)
+//   window     windowed frame, frameSize floats
+//   fft        interleaved re/im spectrum, frameSize/2 + 1 bins
+//   noise_floor  [noise power per magnitude bin, noise mean square of the frame]
+//   magnitude  |fft| for frameSize/2 bins (less the noise floor with noise subtraction)
+//   centroid   spectral centroid in Hz
+//   mel_bands  MEL_BAND_COUNT triangular mel band magnitudes
+//   flux       positive log mel-band flux
+//   onset      [onset strength above the adaptive threshold, 1 on an onset frame]
+// The pipeline adds a ToneNode ("tones") when AnalysisConfig::tones lists frequencies.
+// addStandardNodes() also adds the pitch nodes from HarmonyNodes.hpp (chroma, key, chord, pitch),
+// the drum nodes from PercussionNodes.hpp (hpss, hpss_energy, drums, crossover) and the song
+// structure nodes from StructureNodes.hpp (sections, drop).
+
+// With FrameContext::noiseSubtraction set, rms and magnitude take the
+// noise_floor node as an extra input and subtract that many noise floors in
+// the power domain. Magnitudes keep at least SPECTRAL_FLOOR of their value,
+// which avoids the "musical noise" of bins switching on and off, and the
+// level keeps LEVEL_FLOOR of its own: the floor is learned from the quietest
+// audio seen, which is music when the analysis starts without a pause.
+class RmsNode : public FeatureNode {
+private:
+    static const float LEVEL_FLOOR;
+
+    FrameKernelTable kernels{};
+    size_t frameSize = 0;
+    bool denoise;
+    float subtraction = 0.0f;
+
+public:
+    explicit RmsNode(bool denoise = false) : denoise(denoise) {}
+
+    const char* getName() const override { return "rms"; }
+    std::vector<std::string> getInputs() const override;
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+};
+
+// ITU-R BS.1770 loudness of the newest hop of each frame, so every sample is
+// filtered once. K-weighting is a high-shelf and a high-pass biquad; the mean
+// square of each hop goes into a ring, and running sums over the last 400 ms
+// (momentary) and 3 s (short-term) give the loudness without re-summing the
+// windows. Windows are rounded to whole hops.
+class LoudnessNode : public FeatureNode {
+private:
+    static const double MOMENTARY_SECONDS;
+    static const double SHORT_TERM_SECONDS;
+    static const float MIN_LOUDNESS;
+
+    struct Biquad {
+        double b0, b1, b2, a1, a2;
+    };
+
+    Biquad shelf{};
+    Biquad highPass{};
+    // Transposed direct form II state of both stages
+    double shelfState[2] = {};
+    double highPassState[2] = {};
+
+    size_t frameSize = 0;
+    size_t hopSize = 0;
+    std::vector<double> hopEnergy;   // Ring of per-hop mean squares, SHORT_TERM_SECONDS long
+    size_t ringPos = 0;
+    size_t momentaryHops = 0;
+    double momentarySum = 0.0;
+    double shortTermSum = 0.0;
+
+    float toLoudness(double meanSquare) const;
+
+public:
+    const char* getName() const override { return "loudness"; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+    // The filters settle within milliseconds, so the short-term window is the memory
+    double getSettleSeconds() const override { return SHORT_TERM_SECONDS; }
+};
+
+// Amplitude at a few chosen frequencies, updated on every sample of the
+// newest hop instead of from an FFT frame, so the value read after a hop has
+// no framing delay. Each tone is an exponentially damped sliding DFT bin (a
+// complex one-pole resonator): X = r e^(i w) X + x, with r set by the response
+// time. The tones are stored as structure-of-arrays in groups of eight, and
+// each group runs through the hop in two SSE registers (two independent
+// chains keep the multipliers busy).
+class ToneNode : public FeatureNode {
+private:
+    static const size_t TONE_GROUP = 8;
+
+    std::vector<float> frequencies;
+    float responseSeconds;
+    size_t frameSize = 0;
+    size_t hopSize = 0;
+    float gain = 0.0f;              // Turns |X| into the amplitude of a steady sine
+
+    std::vector<float> rotationRe;  // r cos w, per tone, padded to whole groups
+    std::vector<float> rotationIm;  // r sin w
+    std::vector<float> stateRe;
+    std::vector<float> stateIm;
+
+public:
+    ToneNode(const std::vector<float>& frequencies, float responseSeconds);
+
+    const char* getName() const override { return "tones"; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+};
+
+class WindowNode : public FeatureNode {
+private:
+    FrameKernelTable kernels{};
+    std::vector<float> window;
+
+public:
+    const char* getName() const override { return "window"; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+};
+
+class FftNode : public FeatureNode {
+private:
+    std::shared_ptr<const FFT> fft;
+
+public:
+    const char* getName() const override { return "fft"; }
+    std::vector<std::string> getInputs() const override { return { "window" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+};
+
+// Minimum-statistics noise floor of every bin and of the frame level; see
+// NoiseFloor.hpp
+class NoiseFloorNode : public FeatureNode {
+private:
+    static const float BIN_BIAS_SCALE;   // Bin bias is 1 + this / sqrt(spectra averaged)
+    static const float LEVEL_BIAS;
+
+    FrameKernelTable kernels{};
+    size_t frameSize = 0;
+    std::unique_ptr<NoiseFloor> binFloor;
+    std::unique_ptr<NoiseFloor> levelFloor;
+    std::vector<float> power;
+
+public:
+    const char* getName() const override { return "noise_floor"; }
+    std::vector<std::string> getInputs() const override { return { "fft" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+};
+
+class MagnitudeNode : public FeatureNode {
+private:
+    static const float SPECTRAL_FLOOR;
+
+    FrameKernelTable kernels{};
+    size_t frameSize = 0;
+    bool denoise;
+    float subtraction = 0.0f;
+
+public:
+    explicit MagnitudeNode(bool denoise = false) : denoise(denoise) {}
+
+    const char* getName() const override { return "magnitude"; }
+    std::vector<std::string> getInputs() const override;
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+};
+
+class CentroidNode : public FeatureNode {
+private:
+    FrameKernelTable kernels{};
+    size_t frameSize = 0;
+    float sampleRate = 0.0f;
+
+public:
+    const char* getName() const override { return "centroid"; }
+    std::vector<std::string> getInputs() const override { return { "magnitude" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+};
+
+// Triangular filters evenly spaced on the mel scale. Each band only stores
+// the bins under its triangle.
+class MelBandsNode : public FeatureNode {
+private:
+    static const float MIN_FREQUENCY;
+    static const float MAX_FREQUENCY;
+
+    std::vector<size_t> firstBin;      // Per band
+    std::vector<size_t> weightStart;   // Per band, into weights (plus end marker)
+    std::vector<float> weights;
+
+public:
+    const char* getName() const override { return "mel_bands"; }
+    std::vector<std::string> getInputs() const override { return { "magnitude" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+};
+
+// Half-wave rectified difference of log-compressed mel bands between frames
+class FluxNode : public FeatureNode {
+private:
+    static const float LOG_COMPRESSION;
+
+    std::vector<float> previous;
+
+public:
+    const char* getName() const override { return "flux"; }
+    std::vector<std::string> getInputs() const override { return { "mel_bands" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+};
+
+// Flux peaks above a running mean + k * deviation threshold, with a short
+// refractory period so one hit only fires once
+class OnsetNode : public FeatureNode {
+private:
+    static const float HISTORY_SECONDS;
+    static const float REFRACTORY_SECONDS;
+    static const float SENSITIVITY;
+    static const float MIN_FLUX;
+
+    std::vector<float> history;   // Ring buffer of recent flux values
+    size_t historyPos = 0;
+    size_t historyFilled = 0;
+    size_t refractoryHops = 0;
+    size_t hopsSinceOnset = 0;
+
+public:
+    const char* getName() const override { return "onset"; }
+    std::vector<std::string> getInputs() const override { return { "flux" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+};
+
+// Adds every node above; subscribe to the ones you need before compile(). rms and
+// magnitude subtract the noise floor when the graph's context sets noiseSubtraction.
+void addStandardNodes(FeatureGraph& graph);
+
+#endif // FEATURE_NODES_HPP
@@ -0,0 +1,169 @@
+// FeatureSnapshot.hpp
+#ifndef FEATURE_SNAPSHOT_HPP
+#define FEATURE_SNAPSHOT_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+inline constexpr size_t MEL_BAND_COUNT = 24;
+inline constexpr size_t CHROMA_BIN_COUNT = 12;
+inline constexpr size_t CROSSOVER_BAND_COUNT = 4;
+inline constexpr size_t MAX_TONE_COUNT = 64;
+
+// Published by the sections feature
+enum SectionLabel {
+    SECTION_OTHER,
+    SECTION_BUILD_UP,
+    SECTION_DROP,
+    SECTION_BREAKDOWN,
+};
+
+// Everything the analysis publishes for one hop. Only plain float members
+// (plus the timestamp) so the field table below can address them by offset.
+struct FeatureSnapshot {
+    double time = 0.0;           // Seconds of audio consumed when this hop was produced
+
+    // Lighting-facing values, smoothed and normalized to 0-1
+    float volume = 0.0f;
+    float centroid = 0.0f;
+    float strobe = 0.0f;                 // Percussive level with a fast release (needs hpss_energy)
+
+    // Raw per-hop measurements
+    float rms = 0.0f;
+    float centroidHz = 0.0f;
+    float noiseFloor = 0.0f;             // RMS of the room noise (noise_gate or noise_subtraction), else 0
+    float gate = 1.0f;                   // 0 while the noise gate holds the analysis
+
+    // Only filled in when subscribed (AnalysisConfig::features), zero otherwise
+    float momentaryLoudness = 0.0f;      // K-weighted loudness of the last 400 ms, LUFS
+    float shortTermLoudness = 0.0f;      // Same over the last 3 s
+    float flux = 0.0f;
+    float onsetStrength = 0.0f;
+    float onset = 0.0f;                  // 1 on the hop an onset is detected
+    float melBands[MEL_BAND_COUNT] = {};
+    float chroma[CHROMA_BIN_COUNT] = {};  // Pitch classes C..B, loudest = 1
+    float key = 0.0f;                    // 0-11 C..B major, 12-23 C..B minor
+    float keyStrength = 0.0f;            // Profile correlation of that key, 0 when unknown
+    float chord = 0.0f;                  // Chord + 1, 0 for none: 1-12 C..B major, 13-24 minor, 25-36 seventh
+    float chordConfidence = 0.0f;        // Template similarity of that chord, 0-1
+    float chordChange = 0.0f;            // 1 on the hop a new chord is decided
+    float pitch = 0.0f;                  // Fundamental frequency in Hz, 0 when unvoiced
+    float pitchConfidence = 0.0f;        // Periodicity of the frame, 0-1
+    float harmonic = 0.0f;               // Sustained part of the frame RMS
+    float percussive = 0.0f;             // Transient part of the frame RMS
+    float kick = 0.0f;                   // Hit velocity 0-1 on the hop a kick is decided
+    float snare = 0.0f;
+    float hihat = 0.0f;
+    float hitDelay = 0.0f;               // Seconds between that hit's transient and this snapshot
+    float bandLevels[CROSSOVER_BAND_COUNT] = {};   // Crossover band RMS over the last 64 samples
+    float bassHit = 0.0f;                // Velocity 0-1 on the hop a bass-band hit is found
+    float bassHitDelay = 0.0f;           // Seconds between that hit and this snapshot
+    float tones[MAX_TONE_COUNT] = {};    // Amplitude (0-1 of full scale) at each AnalysisConfig::tones frequency
+    float novelty = 0.0f;                // Structural novelty of the last few seconds
+    float sectionChange = 0.0f;          // 1 on the hop a section change is decided
+    float section = 0.0f;                // SectionLabel of the current section
+    float dropProbability = 0.0f;        // Evidence for an imminent drop, 0-1
+    float dropCountdown = 0.0f;          // Seconds until the expected drop, -1 when none is expected
+    float drop = 0.0f;                   // 1 on the hop a predicted drop lands
+
+    // Recognised pre-analysed track (AnalysisConfig::fingerprintIndex)
+    float matchedTrack = 0.0f;           // Index track + 1, 0 when nothing is recognised
+    float trackPosition = 0.0f;          // Seconds into the recognised track
+    float matchVotes = 0.0f;
+
+    // Position in the followed reference timeline (AnalysisConfig::followTimeline)
+    float referencePosition = 0.0f;      // Seconds into the reference performance
+    float followCost = 0.0f;             // Mean cost per step of the alignment path
+};
+
+// Describes one published feature (or a fixed-size array of them) so logs and
+// tools can walk the snapshot without hard-coding its layout
+struct FeatureField {
+    const char* name;
+    size_t offset;
+    size_t count;
+};
+
+inline constexpr FeatureField FEATURE_FIELDS[] = {
+    { "volume",      offsetof(FeatureSnapshot, volume),     1 },
+    { "centroid",    offsetof(FeatureSnapshot, centroid),   1 },
+    { "strobe",      offsetof(FeatureSnapshot, strobe),     1 },
+    { "rms",         offsetof(FeatureSnapshot, rms),        1 },
+    { "centroid_hz", offsetof(FeatureSnapshot, centroidHz), 1 },
+    { "noise_floor", offsetof(FeatureSnapshot, noiseFloor), 1 },
+    { "gate",        offsetof(FeatureSnapshot, gate),       1 },
+    { "loudness_momentary",  offsetof(FeatureSnapshot, momentaryLoudness), 1 },
+    { "loudness_short_term", offsetof(FeatureSnapshot, shortTermLoudness), 1 },
+    { "flux",        offsetof(FeatureSnapshot, flux),       1 },
+    { "onset_strength", offsetof(FeatureSnapshot, onsetStrength), 1 },
+    { "onset",       offsetof(FeatureSnapshot, onset),      1 },
+    { "mel_bands",   offsetof(FeatureSnapshot, melBands),   MEL_BAND_COUNT },
+    { "chroma",      offsetof(FeatureSnapshot, chroma),     CHROMA_BIN_COUNT },
+    { "key",         offsetof(FeatureSnapshot, key),        1 },
+    { "key_strength", offsetof(FeatureSnapshot, keyStrength), 1 },
+    { "chord",       offsetof(FeatureSnapshot, chord),      1 },
+    { "chord_confidence", offsetof(FeatureSnapshot, chordConfidence), 1 },
+    { "chord_change", offsetof(FeatureSnapshot, chordChange), 1 },
+    { "pitch",       offsetof(FeatureSnapshot, pitch),      1 },
+    { "pitch_confidence", offsetof(FeatureSnapshot, pitchConfidence), 1 },
+    { "harmonic",    offsetof(FeatureSnapshot, harmonic),   1 },
+    { "percussive",  offsetof(FeatureSnapshot, percussive), 1 },
+    { "kick",        offsetof(FeatureSnapshot, kick),       1 },
+    { "snare",       offsetof(FeatureSnapshot, snare),      1 },
+    { "hihat",       offsetof(FeatureSnapshot, hihat),      1 },
+    { "hit_delay",   offsetof(FeatureSnapshot, hitDelay),   1 },
+    { "band_levels", offsetof(FeatureSnapshot, bandLevels), CROSSOVER_BAND_COUNT },
+    { "bass_hit",    offsetof(FeatureSnapshot, bassHit),    1 },
+    { "bass_hit_delay", offsetof(FeatureSnapshot, bassHitDelay), 1 },
+    { "tones",       offsetof(FeatureSnapshot, tones),      MAX_TONE_COUNT },
+    { "novelty",     offsetof(FeatureSnapshot, novelty),    1 },
+    { "section_change", offsetof(FeatureSnapshot, sectionChange), 1 },
+    { "section",     offsetof(FeatureSnapshot, section),    1 },
+    { "drop_probability", offsetof(FeatureSnapshot, dropProbability), 1 },
+    { "drop_countdown",   offsetof(FeatureSnapshot, dropCountdown),   1 },
+    { "drop",        offsetof(FeatureSnapshot, drop),       1 },
+    { "matched_track",  offsetof(FeatureSnapshot, matchedTrack),  1 },
+    { "track_position", offsetof(FeatureSnapshot, trackPosition), 1 },
+    { "match_votes",    offsetof(FeatureSnapshot, matchVotes),    1 },
+    { "reference_position", offsetof(FeatureSnapshot, referencePosition), 1 },
+    { "follow_cost",        offsetof(FeatureSnapshot, followCost),        1 },
+};
+
+inline constexpr size_t FEATURE_FIELD_COUNT = sizeof(FEATURE_FIELDS) / sizeof(FEATURE_FIELDS[0]);
+
+inline const float* featureData(const FeatureSnapshot& snapshot, const FeatureField& field) {
+    return reinterpret_cast<const float*>(reinterpret_cast<const char*>(&snapshot) + field.offset);
+}
+
+inline float* featureData(FeatureSnapshot& snapshot, const FeatureField& field) {
+    return reinterpret_cast<float*>(reinterpret_cast<char*>(&snapshot) + field.offset);
+}
+
+// Field by name, or nullptr
+inline const FeatureField* findFeatureField(const char* name) {
+    for (const FeatureField& field : FEATURE_FIELDS) {
+        if (std::string_view(field.name) == name) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+// One name per float in FEATURE_FIELDS order; arrays expand to name[i]
+inline std::vector<std::string> expandedFeatureNames() {
+    std::vector<std::string> names;
+    for (const FeatureField& field : FEATURE_FIELDS) {
+        if (field.count == 1) {
+            names.push_back(field.name);
+            continue;
+        }
+        for (size_t i = 0; i < field.count; ++i) {
+            names.push_back(std::string(field.name) + "[" + std::to_string(i) + "]");
+        }
+    }
+    return names;
+}
+
+#endif // FEATURE_SNAPSHOT_HPP
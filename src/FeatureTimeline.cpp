@@ -0,0 +1,221 @@
+// FeatureTimeline.cpp
+#include "FeatureTimeline.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+
+static_assert(std::endian::native == std::endian::little, "Feature timelines are mapped in place and stored little-endian");
+
+namespace {
+    const char TIMELINE_MAGIC[4] = { 'I', 'M', 'F', 'T' };
+    const std::uint32_t TIMELINE_VERSION = 1;
+    const std::uint64_t SECTION_ALIGNMENT = 64;
+    const size_t COLUMN_NAME_BYTES = 48;
+
+    struct TimelineHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t headerBytes;
+        std::uint32_t columnCount;
+        std::uint64_t rowCount;
+        std::uint32_t sampleRate;
+        std::uint32_t hopSize;
+        std::uint64_t columnTableOffset;
+        std::uint64_t timeIndexOffset;
+        std::uint64_t fileBytes;
+        std::uint8_t reserved[8];
+    };
+    static_assert(sizeof(TimelineHeader) == 64, "Timeline header layout is part of the file format");
+
+    struct TimelineColumn {
+        char name[COLUMN_NAME_BYTES];
+        std::uint64_t offset;
+        std::uint8_t reserved[8];
+    };
+    static_assert(sizeof(TimelineColumn) == 64, "Timeline column layout is part of the file format");
+
+    std::uint64_t alignSection(std::uint64_t offset) {
+        return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+    }
+
+    void writePadding(std::ofstream& out, std::uint64_t from, std::uint64_t to) {
+        static const char zeros[SECTION_ALIGNMENT] = {};
+        out.write(zeros, static_cast<std::streamsize>(to - from));
+    }
+}
+
+FeatureTimelineWriter::FeatureTimelineWriter(unsigned int sampleRate, unsigned int hopSize)
+    : sampleRate(sampleRate)
+    , hopSize(hopSize)
+    , names(expandedFeatureNames())
+    , columns(names.size())
+{
+}
+
+void FeatureTimelineWriter::append(const FeatureSnapshot& snapshot) {
+    times.push_back(snapshot.time);
+    size_t column = 0;
+    for (const FeatureField& field : FEATURE_FIELDS) {
+        const float* values = featureData(snapshot, field);
+        for (size_t i = 0; i < field.count; ++i) {
+            columns[column++].push_back(values[i]);
+        }
+    }
+}
+
+bool FeatureTimelineWriter::save(const std::string& path, std::string& error) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        error = "Could not open " + path + " for writing";
+        return false;
+    }
+
+    const std::uint64_t rows = times.size();
+    TimelineHeader header{};
+    std::memcpy(header.magic, TIMELINE_MAGIC, sizeof(TIMELINE_MAGIC));
+    header.version = TIMELINE_VERSION;
+    header.headerBytes = sizeof(TimelineHeader);
+    header.columnCount = static_cast<std::uint32_t>(columns.size());
+    header.rowCount = rows;
+    header.sampleRate = sampleRate;
+    header.hopSize = hopSize;
+    header.columnTableOffset = sizeof(TimelineHeader);
+    header.timeIndexOffset = alignSection(header.columnTableOffset + columns.size() * sizeof(TimelineColumn));
+
+    std::vector<TimelineColumn> table(columns.size());
+    std::uint64_t offset = alignSection(header.timeIndexOffset + rows * sizeof(double));
+    for (size_t c = 0; c < columns.size(); ++c) {
+        table[c] = TimelineColumn{};
+        std::strncpy(table[c].name, names[c].c_str(), COLUMN_NAME_BYTES - 1);
+        table[c].offset = offset;
+        offset = alignSection(offset + rows * sizeof(float));
+    }
+    header.fileBytes = offset;
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(TimelineColumn)));
+    std::uint64_t written = header.columnTableOffset + table.size() * sizeof(TimelineColumn);
+    writePadding(out, written, header.timeIndexOffset);
+
+    out.write(reinterpret_cast<const char*>(times.data()), static_cast<std::streamsize>(rows * sizeof(double)));
+    written = header.timeIndexOffset + rows * sizeof(double);
+    for (size_t c = 0; c < columns.size(); ++c) {
+        writePadding(out, written, table[c].offset);
+        out.write(reinterpret_cast<const char*>(columns[c].data()), static_cast<std::streamsize>(rows * sizeof(float)));
+        written = table[c].offset + rows * sizeof(float);
+    }
+    writePadding(out, written, header.fileBytes);
+
+    if (!out) {
+        error = "Error writing " + path;
+        return false;
+    }
+    return true;
+}
+
+FeatureTimeline::FeatureTimeline()
+    : rowCount(0)
+    , sampleRate(0)
+    , hopSize(0)
+    , times(nullptr)
+{
+}
+
+bool FeatureTimeline::open(const std::string& path, std::string& error) {
+    close();
+    if (!file.open(path, error)) {
+        return false;
+    }
+
+    const unsigned char* data = file.getData();
+    const std::uint64_t size = file.getSize();
+    TimelineHeader header;
+    if (size < sizeof(header)) {
+        error = path + " is not a feature timeline";
+        close();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, TIMELINE_MAGIC, sizeof(TIMELINE_MAGIC)) != 0) {
+        error = path + " is not a feature timeline";
+        close();
+        return false;
+    }
+    if (header.version != TIMELINE_VERSION || header.headerBytes != sizeof(TimelineHeader)) {
+        error = path + " has unsupported timeline version " + std::to_string(header.version);
+        close();
+        return false;
+    }
+
+    // Every section must lie inside the file and be aligned for in-place use
+    const std::uint64_t rows = header.rowCount;
+    bool valid = header.fileBytes == size
+              && header.columnTableOffset <= size && header.timeIndexOffset <= size
+              && header.columnTableOffset % SECTION_ALIGNMENT == 0 && header.timeIndexOffset % SECTION_ALIGNMENT == 0
+              && header.columnTableOffset + static_cast<std::uint64_t>(header.columnCount) * sizeof(TimelineColumn) <= size
+              && rows <= size / sizeof(double)
+              && header.timeIndexOffset + rows * sizeof(double) <= size;
+    const TimelineColumn* table = reinterpret_cast<const TimelineColumn*>(data + header.columnTableOffset);
+    for (std::uint32_t c = 0; valid && c < header.columnCount; ++c) {
+        valid = table[c].offset <= size && table[c].offset % SECTION_ALIGNMENT == 0
+             && table[c].offset + rows * sizeof(float) <= size;
+    }
+    if (!valid) {
+        error = path + " is truncated or corrupt";
+        close();
+        return false;
+    }
+
+    rowCount = static_cast<size_t>(rows);
+    sampleRate = header.sampleRate;
+    hopSize = header.hopSize;
+    times = reinterpret_cast<const double*>(data + header.timeIndexOffset);
+    for (std::uint32_t c = 0; c < header.columnCount; ++c) {
+        columnNames.push_back(std::string(table[c].name, strnlen(table[c].name, COLUMN_NAME_BYTES)));
+        columns.push_back(reinterpret_cast<const float*>(data + table[c].offset));
+    }
+
+    for (const std::string& name : expandedFeatureNames()) {
+        snapshotColumns.push_back(findColumn(name));
+    }
+    return true;
+}
+
+void FeatureTimeline::close() {
+    file.close();
+    rowCount = 0;
+    sampleRate = 0;
+    hopSize = 0;
+    times = nullptr;
+    columnNames.clear();
+    columns.clear();
+    snapshotColumns.clear();
+}
+
+size_t FeatureTimeline::findColumn(const std::string& name) const {
+    auto it = std::find(columnNames.begin(), columnNames.end(), name);
+    return it == columnNames.end() ? NO_COLUMN : static_cast<size_t>(it - columnNames.begin());
+}
+
+size_t FeatureTimeline::findRow(double seconds) const {
+    const double* end = times + rowCount;
+    const double* after = std::upper_bound(times, end, seconds);
+    return after == times ? 0 : static_cast<size_t>(after - times) - 1;
+}
+
+void FeatureTimeline::readSnapshot(size_t row, FeatureSnapshot& snapshot) const {
+    snapshot = FeatureSnapshot();
+    if (row >= rowCount) {
+        return;
+    }
+    snapshot.time = times[row];
+    size_t index = 0;
+    for (const FeatureField& field : FEATURE_FIELDS) {
+        float* values = featureData(snapshot, field);
+        for (size_t i = 0; i < field.count; ++i, ++index) {
+            size_t column = snapshotColumns[index];
+            values[i] = column == NO_COLUMN ? 0.0f : columns[column][row];
+        }
+    }
+}
@@ -0,0 +1,88 @@
+// FeatureTimeline.hpp
+#ifndef FEATURE_TIMELINE_HPP
+#define FEATURE_TIMELINE_HPP
+
+#include "FeatureSnapshot.hpp"
+#include "MappedFile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Column-per-feature timeline of analysed features, for pre-analysed tracks
+// and recorded shows. Designed to be memory-mapped and used in place: there
+// is no parse step, so opening a multi-hour timeline costs the same as a
+// short one and any timestamp can be looked up immediately.
+//
+// Layout (little-endian, every section 64-byte aligned):
+//   header        64 bytes: "IMFT", u32 version, u32 headerBytes, u32 columnCount,
+//                 u64 rowCount, u32 sampleRate, u32 hopSize, u64 columnTableOffset,
+//                 u64 timeIndexOffset, u64 fileBytes, 8 reserved bytes
+//   column table  columnCount x 64 bytes: char name[48] (NUL padded), u64 offset,
+//                 8 reserved bytes
+//   time index    f64 seconds[rowCount], ascending
+//   columns       f32 values[rowCount] each, at the offsets in the column table
+//
+// Column names are the expanded snapshot field names ("rms", "mel_bands[3]"),
+// so files written by builds with other feature sets still line up by name.
+class FeatureTimelineWriter {
+private:
+    unsigned int sampleRate;
+    unsigned int hopSize;
+    std::vector<std::string> names;
+    std::vector<double> times;
+    std::vector<std::vector<float>> columns;
+
+public:
+    FeatureTimelineWriter(unsigned int sampleRate, unsigned int hopSize);
+
+    // Rows must be appended in time order
+    void append(const FeatureSnapshot& snapshot);
+    bool save(const std::string& path, std::string& error) const;
+
+    size_t getRowCount() const { return times.size(); }
+};
+
+class FeatureTimeline {
+private:
+    MappedFile file;
+    size_t rowCount;
+    unsigned int sampleRate;
+    unsigned int hopSize;
+    std::vector<std::string> columnNames;
+    std::vector<const float*> columns;
+    const double* times;
+
+    // Column holding each float of FeatureSnapshot (FEATURE_FIELDS order), or NO_COLUMN
+    std::vector<size_t> snapshotColumns;
+
+public:
+    static const size_t NO_COLUMN = static_cast<size_t>(-1);
+
+    FeatureTimeline();
+
+    // Maps the file and checks its header and section bounds
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    size_t getRowCount() const { return rowCount; }
+    size_t getColumnCount() const { return columns.size(); }
+    unsigned int getSampleRate() const { return sampleRate; }
+    unsigned int getHopSize() const { return hopSize; }
+    const std::string& getColumnName(size_t column) const { return columnNames[column]; }
+    size_t findColumn(const std::string& name) const;
+    double getDuration() const { return rowCount ? times[rowCount - 1] : 0.0; }
+
+    // Zero-copy views into the mapping
+    std::span<const float> getColumn(size_t column) const { return std::span<const float>(columns[column], rowCount); }
+    std::span<const double> getTimes() const { return std::span<const double>(times, rowCount); }
+
+    // Last row at or before seconds (row 0 for earlier times); binary search
+    size_t findRow(double seconds) const;
+
+    // Fills every snapshot field the file has a column for; others are zeroed
+    void readSnapshot(size_t row, FeatureSnapshot& snapshot) const;
+};
+
+#endif // FEATURE_TIMELINE_HPP
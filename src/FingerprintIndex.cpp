@@ -0,0 +1,218 @@
+// FingerprintIndex.cpp
+#include "FingerprintIndex.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+static_assert(std::endian::native == std::endian::little, "Fingerprint indexes are mapped in place and stored little-endian");
+
+namespace {
+    const char INDEX_MAGIC[4] = { 'I', 'M', 'F', 'P' };
+    const std::uint32_t INDEX_VERSION = 1;
+    const std::uint64_t SECTION_ALIGNMENT = 64;
+    const size_t TIMELINE_NAME_BYTES = 120;
+
+    struct IndexHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t sampleRate;
+        std::uint32_t hopSize;
+        std::uint32_t frameSize;
+        std::uint32_t trackCount;
+        std::uint32_t hashCount;
+        std::uint32_t reserved;
+        std::uint64_t entryCount;
+        std::uint64_t trackTableOffset;
+        std::uint64_t hashTableOffset;
+        std::uint64_t entryOffset;
+        std::uint64_t fileBytes;
+    };
+    static_assert(sizeof(IndexHeader) == 72, "Index header layout is part of the file format");
+
+    struct IndexTrack {
+        char timeline[TIMELINE_NAME_BYTES];
+        std::uint32_t frameCount;
+        std::uint32_t reserved;
+    };
+    static_assert(sizeof(IndexTrack) == 128, "Index track layout is part of the file format");
+    static_assert(sizeof(FingerprintEntry) == 8, "Index entry layout is part of the file format");
+
+    std::uint64_t alignSection(std::uint64_t offset) {
+        return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+    }
+
+    void writePadding(std::ofstream& out, std::uint64_t from, std::uint64_t to) {
+        static const char zeros[SECTION_ALIGNMENT] = {};
+        out.write(zeros, static_cast<std::streamsize>(to - from));
+    }
+
+    template <typename T>
+    void writeArray(std::ofstream& out, const std::vector<T>& values) {
+        out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+}
+
+FingerprintIndexBuilder::FingerprintIndexBuilder(unsigned int sampleRate, unsigned int hopSize, unsigned int frameSize)
+    : sampleRate(sampleRate)
+    , hopSize(hopSize)
+    , frameSize(frameSize)
+{
+}
+
+void FingerprintIndexBuilder::addTrack(const std::string& timeline, std::uint32_t frameCount, const std::vector<Landmark>& landmarks) {
+    std::uint32_t track = static_cast<std::uint32_t>(timelines.size());
+    timelines.push_back(timeline);
+    frameCounts.push_back(frameCount);
+    for (const Landmark& landmark : landmarks) {
+        postings.push_back(Posting{ landmark.hash, FingerprintEntry{ track, landmark.frame } });
+    }
+}
+
+bool FingerprintIndexBuilder::save(const std::string& path, std::string& error) {
+    for (const std::string& timeline : timelines) {
+        if (timeline.size() >= TIMELINE_NAME_BYTES) {
+            error = "Timeline path too long for the fingerprint index: " + timeline;
+            return false;
+        }
+    }
+
+    std::sort(postings.begin(), postings.end(), [](const Posting& a, const Posting& b) {
+        if (a.hash != b.hash) return a.hash < b.hash;
+        if (a.entry.track != b.entry.track) return a.entry.track < b.entry.track;
+        return a.entry.frame < b.entry.frame;
+    });
+
+    std::vector<std::uint32_t> hashes;
+    std::vector<std::uint32_t> firstEntry;
+    std::vector<FingerprintEntry> entries;
+    entries.reserve(postings.size());
+    for (const Posting& posting : postings) {
+        if (hashes.empty() || hashes.back() != posting.hash) {
+            hashes.push_back(posting.hash);
+            firstEntry.push_back(static_cast<std::uint32_t>(entries.size()));
+        }
+        entries.push_back(posting.entry);
+    }
+    firstEntry.push_back(static_cast<std::uint32_t>(entries.size()));
+
+    std::vector<IndexTrack> tracks(timelines.size());
+    for (size_t t = 0; t < timelines.size(); ++t) {
+        tracks[t] = IndexTrack{};
+        std::memcpy(tracks[t].timeline, timelines[t].data(), timelines[t].size());
+        tracks[t].frameCount = frameCounts[t];
+    }
+
+    IndexHeader header{};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_VERSION;
+    header.sampleRate = sampleRate;
+    header.hopSize = hopSize;
+    header.frameSize = frameSize;
+    header.trackCount = static_cast<std::uint32_t>(tracks.size());
+    header.hashCount = static_cast<std::uint32_t>(hashes.size());
+    header.entryCount = entries.size();
+    header.trackTableOffset = alignSection(sizeof(IndexHeader));
+    header.hashTableOffset = alignSection(header.trackTableOffset + tracks.size() * sizeof(IndexTrack));
+    std::uint64_t firstEntryOffset = header.hashTableOffset + hashes.size() * sizeof(std::uint32_t);
+    header.entryOffset = alignSection(firstEntryOffset + firstEntry.size() * sizeof(std::uint32_t));
+    header.fileBytes = alignSection(header.entryOffset + entries.size() * sizeof(FingerprintEntry));
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        error = "Could not open " + path + " for writing";
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writePadding(out, sizeof(header), header.trackTableOffset);
+    writeArray(out, tracks);
+    writePadding(out, header.trackTableOffset + tracks.size() * sizeof(IndexTrack), header.hashTableOffset);
+    writeArray(out, hashes);
+    writeArray(out, firstEntry);
+    writePadding(out, firstEntryOffset + firstEntry.size() * sizeof(std::uint32_t), header.entryOffset);
+    writeArray(out, entries);
+    writePadding(out, header.entryOffset + entries.size() * sizeof(FingerprintEntry), header.fileBytes);
+
+    if (!out) {
+        error = "Error writing " + path;
+        return false;
+    }
+    return true;
+}
+
+FingerprintIndex::FingerprintIndex()
+    : sampleRate(0)
+    , hopSize(0)
+    , frameSize(0)
+{
+}
+
+bool FingerprintIndex::open(const std::string& path, std::string& error) {
+    if (!file.open(path, error)) {
+        return false;
+    }
+
+    const unsigned char* data = file.getData();
+    const std::uint64_t size = file.getSize();
+    IndexHeader header;
+    if (size < sizeof(header) || std::memcmp(data, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        error = path + " is not a fingerprint index";
+        file.close();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != INDEX_VERSION) {
+        error = path + " has unsupported fingerprint index version " + std::to_string(header.version);
+        file.close();
+        return false;
+    }
+
+    const std::uint64_t firstEntryOffset = header.hashTableOffset + static_cast<std::uint64_t>(header.hashCount) * sizeof(std::uint32_t);
+    bool valid = header.fileBytes == size
+              && header.trackTableOffset <= size && header.hashTableOffset <= size && header.entryOffset <= size
+              && header.trackTableOffset % SECTION_ALIGNMENT == 0 && header.hashTableOffset % SECTION_ALIGNMENT == 0
+              && header.entryOffset % SECTION_ALIGNMENT == 0
+              && header.trackTableOffset + static_cast<std::uint64_t>(header.trackCount) * sizeof(IndexTrack) <= size
+              && firstEntryOffset + (static_cast<std::uint64_t>(header.hashCount) + 1) * sizeof(std::uint32_t) <= size
+              && header.entryCount <= size / sizeof(FingerprintEntry)
+              && header.entryOffset + header.entryCount * sizeof(FingerprintEntry) <= size;
+    if (valid) {
+        hashes = std::span<const std::uint32_t>(reinterpret_cast<const std::uint32_t*>(data + header.hashTableOffset), header.hashCount);
+        firstEntry = std::span<const std::uint32_t>(reinterpret_cast<const std::uint32_t*>(data + firstEntryOffset), header.hashCount + 1);
+        entries = std::span<const FingerprintEntry>(reinterpret_cast<const FingerprintEntry*>(data + header.entryOffset), header.entryCount);
+        valid = firstEntry.back() == header.entryCount;
+    }
+    if (!valid) {
+        error = path + " is truncated or corrupt";
+        file.close();
+        return false;
+    }
+
+    sampleRate = header.sampleRate;
+    hopSize = header.hopSize;
+    frameSize = header.frameSize;
+    directory = std::filesystem::path(path).parent_path().string();
+    const IndexTrack* tracks = reinterpret_cast<const IndexTrack*>(data + header.trackTableOffset);
+    for (std::uint32_t t = 0; t < header.trackCount; ++t) {
+        timelines.push_back(std::string(tracks[t].timeline, strnlen(tracks[t].timeline, TIMELINE_NAME_BYTES)));
+        frameCounts.push_back(tracks[t].frameCount);
+    }
+    return true;
+}
+
+std::span<const FingerprintEntry> FingerprintIndex::lookup(std::uint32_t hash) const {
+    auto it = std::lower_bound(hashes.begin(), hashes.end(), hash);
+    if (it == hashes.end() || *it != hash) {
+        return {};
+    }
+    size_t position = static_cast<size_t>(it - hashes.begin());
+    // Clamped so a corrupt table can never reach outside the mapping
+    size_t first = std::min<size_t>(firstEntry[position], entries.size());
+    size_t last = std::max(first, std::min<size_t>(firstEntry[position + 1], entries.size()));
+    return entries.subspan(first, last - first);
+}
+
+std::string FingerprintIndex::getTimelinePath(size_t track) const {
+    return (std::filesystem::path(directory) / timelines[track]).string();
+}
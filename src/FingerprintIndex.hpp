@@ -0,0 +1,81 @@
+// FingerprintIndex.hpp
+#ifndef FINGERPRINT_INDEX_HPP
+#define FINGERPRINT_INDEX_HPP
+
+#include "Fingerprinter.hpp"
+#include "MappedFile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// On-disk inverted index from landmark hash to (track, frame), built offline
+// by BatchAnalyzer and memory-mapped by the live matcher.
+//
+// Layout (little-endian, sections 64-byte aligned):
+//   header       72 bytes: "IMFP", u32 version, u32 sampleRate, u32 hopSize, u32 frameSize,
+//                u32 trackCount, u32 hashCount, u32 reserved, u64 entryCount,
+//                u64 trackTableOffset, u64 hashTableOffset, u64 entryOffset, u64 fileBytes
+//   track table  trackCount x 128 bytes: char timeline[120] (path relative to the
+//                index file, NUL padded), u32 frameCount, u32 reserved
+//   hash table   u32 hashes[hashCount] ascending, then u32 firstEntry[hashCount + 1]
+//   entries      entryCount x (u32 track, u32 frame), grouped by hash
+struct FingerprintEntry {
+    std::uint32_t track;
+    std::uint32_t frame;
+};
+
+class FingerprintIndexBuilder {
+private:
+    unsigned int sampleRate;
+    unsigned int hopSize;
+    unsigned int frameSize;
+    std::vector<std::string> timelines;
+    std::vector<std::uint32_t> frameCounts;
+
+    struct Posting {
+        std::uint32_t hash;
+        FingerprintEntry entry;
+    };
+    std::vector<Posting> postings;
+
+public:
+    FingerprintIndexBuilder(unsigned int sampleRate, unsigned int hopSize, unsigned int frameSize);
+
+    // Adds one track; timeline is the feature timeline path relative to the index
+    void addTrack(const std::string& timeline, std::uint32_t frameCount, const std::vector<Landmark>& landmarks);
+    bool save(const std::string& path, std::string& error);
+};
+
+class FingerprintIndex {
+private:
+    MappedFile file;
+    std::string directory;   // Timeline paths are relative to this
+    unsigned int sampleRate;
+    unsigned int hopSize;
+    unsigned int frameSize;
+    std::vector<std::string> timelines;
+    std::vector<std::uint32_t> frameCounts;
+    std::span<const std::uint32_t> hashes;
+    std::span<const std::uint32_t> firstEntry;
+    std::span<const FingerprintEntry> entries;
+
+public:
+    FingerprintIndex();
+
+    bool open(const std::string& path, std::string& error);
+
+    // Entries for one hash (empty if unknown); binary search, no allocation
+    std::span<const FingerprintEntry> lookup(std::uint32_t hash) const;
+
+    size_t getTrackCount() const { return timelines.size(); }
+    std::string getTimelinePath(size_t track) const;
+    std::uint32_t getFrameCount(size_t track) const { return frameCounts[track]; }
+    unsigned int getSampleRate() const { return sampleRate; }
+    unsigned int getHopSize() const { return hopSize; }
+    unsigned int getFrameSize() const { return frameSize; }
+    size_t getEntryCount() const { return entries.size(); }
+};
+
+#endif // FINGERPRINT_INDEX_HPP
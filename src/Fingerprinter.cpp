@@ -0,0 +1,148 @@
+// Fingerprinter.cpp
+#include "Fingerprinter.hpp"
+#include <algorithm>
+#include <cmath>
+
+const float Fingerprinter::MIN_FREQUENCY = 150.0f;
+const float Fingerprinter::MAX_FREQUENCY = 4000.0f;
+const float Fingerprinter::MIN_MAGNITUDE = 0.05f;
+const float Fingerprinter::MEAN_RATIO = 3.0f;
+
+namespace {
+    const size_t RING_FRAMES = 7;   // 2 * TIME_RADIUS + 1
+}
+
+Fingerprinter::Fingerprinter(size_t frameSize, unsigned int sampleRate)
+    : framesSeen(0)
+    , recentStart(0)
+    , recentCount(0)
+{
+    static_assert(RING_FRAMES == 2 * TIME_RADIUS + 1, "Ring must cover the peak neighbourhood");
+
+    size_t spectrumBins = frameSize / 2;
+    float binWidth = static_cast<float>(sampleRate) / frameSize;
+    firstBin = std::min(spectrumBins - 1, static_cast<size_t>(std::ceil(MIN_FREQUENCY / binWidth)));
+    size_t lastBin = std::min(spectrumBins, static_cast<size_t>(MAX_FREQUENCY / binWidth) + 1);
+    bandBins = std::max<size_t>(1, lastBin - firstBin);
+    binStep = (bandBins + QUANTISED_BINS - 1) / QUANTISED_BINS;
+
+    frames.assign(RING_FRAMES * bandBins, 0.0f);
+    frequencyMax.assign(RING_FRAMES * bandBins, 0.0f);
+    frameMeans.assign(RING_FRAMES, 0.0f);
+    recentPeaks.resize((MAX_DELTA_FRAMES + 1) * MAX_PEAKS_PER_FRAME);
+}
+
+void Fingerprinter::reset() {
+    std::fill(frames.begin(), frames.end(), 0.0f);
+    std::fill(frequencyMax.begin(), frequencyMax.end(), 0.0f);
+    std::fill(frameMeans.begin(), frameMeans.end(), 0.0f);
+    framesSeen = 0;
+    recentStart = 0;
+    recentCount = 0;
+}
+
+void Fingerprinter::pickPeaks(size_t centreSlot, std::uint32_t centreFrame, Peak* peaks, size_t& peakCount) const {
+    const float* centre = frames.data() + centreSlot * bandBins;
+    const float* centreMax = frequencyMax.data() + centreSlot * bandBins;
+    float threshold = std::max(MIN_MAGNITUDE, MEAN_RATIO * frameMeans[centreSlot]);
+
+    peakCount = 0;
+    for (size_t bin = 0; bin < bandBins; ++bin) {
+        float value = centre[bin];
+        if (value < threshold || value < centreMax[bin]) {
+            continue;   // Below the floor or not the largest along frequency
+        }
+        // Other frames' neighbourhoods must all be strictly smaller
+        bool dominates = true;
+        for (size_t slot = 0; slot < RING_FRAMES && dominates; ++slot) {
+            dominates = slot == centreSlot || frequencyMax[slot * bandBins + bin] < value;
+        }
+        if (!dominates) {
+            continue;
+        }
+
+        // Keep the strongest MAX_PEAKS_PER_FRAME, sorted by descending magnitude
+        Peak peak{ centreFrame, static_cast<std::uint32_t>(bin / binStep), value };
+        size_t pos = std::min(peakCount, MAX_PEAKS_PER_FRAME - 1);
+        if (peakCount == MAX_PEAKS_PER_FRAME && peaks[pos].magnitude >= value) {
+            continue;
+        }
+        while (pos > 0 && peaks[pos - 1].magnitude < value) {
+            peaks[pos] = peaks[pos - 1];
+            --pos;
+        }
+        peaks[pos] = peak;
+        peakCount = std::min(peakCount + 1, MAX_PEAKS_PER_FRAME);
+    }
+}
+
+void Fingerprinter::rememberPeak(const Peak& peak) {
+    if (recentCount == recentPeaks.size()) {
+        recentStart = (recentStart + 1) % recentPeaks.size();
+        --recentCount;
+    }
+    recentPeaks[(recentStart + recentCount) % recentPeaks.size()] = peak;
+    ++recentCount;
+}
+
+size_t Fingerprinter::addFrame(const float* magnitudes, std::uint32_t frame, Landmark* out) {
+    // Store the band and its max filter along frequency
+    size_t slot = framesSeen % RING_FRAMES;
+    float* band = frames.data() + slot * bandBins;
+    float* bandMax = frequencyMax.data() + slot * bandBins;
+    float sum = 0.0f;
+    for (size_t bin = 0; bin < bandBins; ++bin) {
+        band[bin] = magnitudes[firstBin + bin];
+        sum += band[bin];
+    }
+    frameMeans[slot] = sum / bandBins;
+    for (size_t bin = 0; bin < bandBins; ++bin) {
+        size_t low = bin > FREQ_RADIUS ? bin - FREQ_RADIUS : 0;
+        size_t high = std::min(bandBins, bin + FREQ_RADIUS + 1);
+        float neighbourhoodMax = 0.0f;
+        for (size_t other = low; other < high; ++other) {
+            neighbourhoodMax = std::max(neighbourhoodMax, band[other]);
+        }
+        bandMax[bin] = neighbourhoodMax;
+    }
+    ++framesSeen;
+
+    if (framesSeen < RING_FRAMES || frame < TIME_RADIUS) {
+        return 0;
+    }
+
+    // The centre frame now has TIME_RADIUS frames on either side
+    size_t centreSlot = (framesSeen - 1 - TIME_RADIUS) % RING_FRAMES;
+    std::uint32_t centreFrame = frame - static_cast<std::uint32_t>(TIME_RADIUS);
+
+    Peak peaks[MAX_PEAKS_PER_FRAME];
+    size_t peakCount = 0;
+    pickPeaks(centreSlot, centreFrame, peaks, peakCount);
+
+    size_t landmarkCount = 0;
+    for (size_t p = 0; p < peakCount; ++p) {
+        const Peak& target = peaks[p];
+        size_t paired = 0;
+        // Newest anchors first
+        for (size_t r = recentCount; r > 0 && paired < FAN_OUT; --r) {
+            const Peak& anchor = recentPeaks[(recentStart + r - 1) % recentPeaks.size()];
+            std::uint32_t delta = target.frame - anchor.frame;
+            if (delta == 0) {
+                continue;
+            }
+            if (delta > MAX_DELTA_FRAMES) {
+                break;
+            }
+            std::uint32_t binDistance = anchor.bin > target.bin ? anchor.bin - target.bin : target.bin - anchor.bin;
+            if (binDistance > MAX_DELTA_BINS) {
+                continue;
+            }
+            out[landmarkCount++] = Landmark{ (anchor.bin << 16) | (target.bin << 6) | delta, anchor.frame };
+            ++paired;
+        }
+    }
+    for (size_t p = 0; p < peakCount; ++p) {
+        rememberPeak(peaks[p]);
+    }
+    return landmarkCount;
+}
@@ -0,0 +1,80 @@
+// Fingerprinter.hpp
+#ifndef FINGERPRINTER_HPP
+#define FINGERPRINTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One spectrogram landmark: a hash of two nearby peaks (anchor frequency,
+// target frequency, frame distance) and the frame of the anchor peak
+struct Landmark {
+    std::uint32_t hash;
+    std::uint32_t frame;
+};
+
+// Streaming landmark fingerprinter over magnitude spectra (the graph's
+// "magnitude" output). Peaks are local maxima over a small time/frequency
+// neighbourhood, found with a separable max filter over a short ring of
+// frames; each new peak is paired with a few recent peaks to form hashes.
+// Offline analysis and live matching feed the same frames through the same
+// code, so hashes only match between identical frame/hop/rate settings.
+// Everything is sized in the constructor; addFrame() never allocates.
+class Fingerprinter {
+private:
+    static const float MIN_FREQUENCY;
+    static const float MAX_FREQUENCY;
+    static const float MIN_MAGNITUDE;       // Ignore peaks in near-silence
+    static const float MEAN_RATIO;          // Peak must be this much above the frame mean
+    static const size_t TIME_RADIUS = 3;    // Frames either side a peak must dominate
+    static const size_t FREQ_RADIUS = 6;    // Bins either side
+    static const size_t MAX_PEAKS_PER_FRAME = 5;
+    static const size_t FAN_OUT = 5;        // Anchors paired with each new peak
+    static const size_t MAX_DELTA_FRAMES = 63;
+    static const size_t MAX_DELTA_BINS = 128;
+    static const size_t QUANTISED_BINS = 1024;
+
+    struct Peak {
+        std::uint32_t frame;
+        std::uint32_t bin;      // Quantised, < QUANTISED_BINS
+        float magnitude;
+    };
+
+    size_t firstBin;
+    size_t bandBins;
+    size_t binStep;             // Spectrum bins per quantised bin
+
+    // Ring of the last 2 * TIME_RADIUS + 1 frames: band magnitudes and their
+    // frequency-direction max filter
+    std::vector<float> frames;
+    std::vector<float> frequencyMax;
+    std::vector<float> frameMeans;
+    size_t framesSeen;
+
+    // Recent peaks available as anchors, oldest first within the ring
+    std::vector<Peak> recentPeaks;
+    size_t recentStart;
+    size_t recentCount;
+
+    void pickPeaks(size_t centreSlot, std::uint32_t centreFrame, Peak* peaks, size_t& peakCount) const;
+    void rememberPeak(const Peak& peak);
+
+public:
+    static const size_t MAX_LANDMARKS_PER_FRAME = MAX_PEAKS_PER_FRAME * FAN_OUT;
+
+    Fingerprinter(size_t frameSize, unsigned int sampleRate);
+
+    // Adds the magnitude spectrum of hop `frame` (frames must be consecutive)
+    // and writes up to MAX_LANDMARKS_PER_FRAME landmarks to out. Peaks are
+    // confirmed TIME_RADIUS frames late, so landmarks lag the input slightly.
+    size_t addFrame(const float* magnitudes, std::uint32_t frame, Landmark* out);
+
+    void reset();
+
+    // Frames of input needed before a given peak is confirmed
+    static size_t getLatencyFrames() { return TIME_RADIUS; }
+    // Frames of history a landmark can reach back over
+    static size_t getHistoryFrames() { return TIME_RADIUS + MAX_DELTA_FRAMES; }
+};
+
+#endif // FINGERPRINTER_HPP
@@ -0,0 +1,28 @@
+// FrameArena.cpp
+#include "FrameArena.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+FrameArena::FrameArena(size_t capacityBytes)
+    : storage(new unsigned char[capacityBytes + ALIGNMENT])
+    , capacity(capacityBytes)
+    , used(0)
+    , highWater(0)
+{
+}
+
+void* FrameArena::allocateBytes(size_t bytes) {
+    // Offsets are aligned relative to an aligned base
+    unsigned char* base = storage.get();
+    size_t baseOffset = (ALIGNMENT - reinterpret_cast<std::uintptr_t>(base) % ALIGNMENT) % ALIGNMENT;
+    size_t offset = (used + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+    if (offset + bytes > capacity) {
+        throw std::runtime_error("FrameArena exhausted: per-frame scratch exceeds the preallocated block");
+    }
+
+    used = offset + bytes;
+    highWater = std::max(highWater, used);
+    return base + baseOffset + offset;
+}
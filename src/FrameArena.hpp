@@ -0,0 +1,44 @@
+// FrameArena.hpp
+#ifndef FRAME_ARENA_HPP
+#define FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+// Bump allocator for per-frame scratch buffers. The block is allocated once
+// up front; allocate() hands out aligned slices of it and reset() at the start
+// of every frame makes the whole block available again, so the analysis hot
+// loop never touches the heap. Running out of space is a sizing bug and throws.
+class FrameArena {
+private:
+    std::unique_ptr<unsigned char[]> storage;
+    size_t capacity;
+    size_t used;
+    size_t highWater;
+
+    void* allocateBytes(size_t bytes);
+
+public:
+    static const size_t ALIGNMENT = 64;  // Cache line, also enough for any SIMD type
+
+    explicit FrameArena(size_t capacityBytes);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Uninitialised storage for count objects; valid until the next reset()
+    template <typename T>
+    std::span<T> allocate(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "FrameArena never runs destructors");
+        return std::span<T>(static_cast<T*>(allocateBytes(count * sizeof(T))), count);
+    }
+
+    void reset() { used = 0; }
+
+    size_t getCapacity() const { return capacity; }
+    size_t getHighWater() const { return highWater; }
+};
+
+#endif // FRAME_ARENA_HPP
@@ -0,0 +1,82 @@
+// FrameKernels.hpp
+#ifndef FRAME_KERNELS_HPP
+#define FRAME_KERNELS_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Per-frame analysis kernels, instantiated for the common frame sizes so the
+// compiler sees constant loop bounds (full unrolling/vectorisation, no tail
+// handling). N == 0 is the generic instantiation that takes the size at run
+// time; feature nodes pick an instantiation once when the graph is compiled.
+template <size_t N>
+struct FrameKernels {
+    static float rms(const std::int16_t* samples, size_t count) {
+        const size_t n = N ? N : count;
+        double sum = 0.0;  // Using double for better precision in accumulation
+        for (size_t i = 0; i < n; ++i) {
+            float normalized = samples[i] / 32768.0f;  // Normalize 16-bit audio
+            sum += normalized * normalized;
+        }
+        return static_cast<float>(std::sqrt(sum / n));
+    }
+
+    static void window(const std::int16_t* samples, const float* window, float* windowed, size_t count) {
+        const size_t n = N ? N : count;
+        for (size_t i = 0; i < n; ++i) {
+            windowed[i] = (samples[i] / 32768.0f) * window[i];
+        }
+    }
+
+    // |X[k]| for the first count/2 bins of an interleaved re/im spectrum
+    static void magnitude(const float* spectrum, float* magnitudes, size_t count) {
+        const size_t bins = (N ? N : count) / 2;
+        for (size_t i = 0; i < bins; ++i) {
+            float re = spectrum[2 * i];
+            float im = spectrum[2 * i + 1];
+            magnitudes[i] = std::sqrt(re * re + im * im);
+        }
+    }
+
+    static float centroid(const float* magnitudes, float sampleRate, size_t count) {
+        const size_t bins = (N ? N : count) / 2;
+        float numerator = 0.0f;
+        float denominator = 0.0f;
+        for (size_t i = 0; i < bins; ++i) {
+            float frequency = static_cast<float>(i) * sampleRate / (2.0f * bins);
+            numerator += frequency * magnitudes[i];
+            denominator += magnitudes[i];
+        }
+        return denominator > 0.0f ? numerator / denominator : 0.0f;
+    }
+};
+
+// Function table for one frame size
+struct FrameKernelTable {
+    float (*rms)(const std::int16_t*, size_t);
+    void (*window)(const std::int16_t*, const float*, float*, size_t);
+    void (*magnitude)(const float*, float*, size_t);
+    float (*centroid)(const float*, float, size_t);
+    bool specialised;
+};
+
+template <size_t N>
+constexpr FrameKernelTable makeFrameKernelTable() {
+    return FrameKernelTable{ &FrameKernels<N>::rms, &FrameKernels<N>::window, &FrameKernels<N>::magnitude,
+                             &FrameKernels<N>::centroid, N != 0 };
+}
+
+// Specialised kernels for 512-8192, generic ones for anything else
+inline FrameKernelTable selectFrameKernels(size_t frameSize) {
+    switch (frameSize) {
+    case 512:  return makeFrameKernelTable<512>();
+    case 1024: return makeFrameKernelTable<1024>();
+    case 2048: return makeFrameKernelTable<2048>();
+    case 4096: return makeFrameKernelTable<4096>();
+    case 8192: return makeFrameKernelTable<8192>();
+    default:   return makeFrameKernelTable<0>();
+    }
+}
+
+#endif // FRAME_KERNELS_HPP
@@ -0,0 +1,409 @@
+// HarmonyNodes.cpp
+#define _USE_MATH_DEFINES
+
+#include "HarmonyNodes.hpp"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define HARMONY_USE_SSE 1
+#endif
+
+namespace {
+
+// Krumhansl-Kessler probe-tone profiles, tonic first
+const float MAJOR_PROFILE[CHROMA_BIN_COUNT] = { 6.35f, 2.23f, 3.48f, 2.33f, 4.38f, 4.09f, 2.52f, 5.19f, 2.39f, 3.66f, 2.29f, 2.88f };
+const float MINOR_PROFILE[CHROMA_BIN_COUNT] = { 6.33f, 2.68f, 3.52f, 5.38f, 2.60f, 3.53f, 2.54f, 4.75f, 3.98f, 2.69f, 3.34f, 3.17f };
+
+// Removes the mean and scales to unit length; returns false for a flat vector
+bool standardise(float* values, size_t count) {
+    float mean = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        mean += values[i];
+    }
+    mean /= count;
+    float sumSquares = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        values[i] -= mean;
+        sumSquares += values[i] * values[i];
+    }
+    if (sumSquares <= 1e-12f) {
+        return false;
+    }
+    float scale = 1.0f / std::sqrt(sumSquares);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] *= scale;
+    }
+    return true;
+}
+
+} // namespace
+
+const float ChromaNode::KERNEL_THRESHOLD = 0.01f;
+const double ChromaNode::FILTER_SCALE = 2.0;
+const float KeyNode::DECAY_SECONDS = 15.0f;
+const float KeyNode::SETTLE_DECAYS = 5.0f;
+const float ChordNode::LAG_SECONDS = 0.25f;
+const float ChordNode::SHARPNESS = 20.0f;
+const float ChordNode::NO_CHORD_SIMILARITY = 0.6f;
+const float ChordNode::SWITCH_PENALTY = 8.0f;
+const float PitchNode::MIN_FREQUENCY = 40.0f;
+const float PitchNode::MAX_FREQUENCY = 2000.0f;
+const float PitchNode::THRESHOLD = 0.15f;
+const float PitchNode::VOICED_LIMIT = 0.35f;
+const float PitchNode::MIN_LEVEL = 1e-8f;      // -80 dBFS
+
+size_t ChromaNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    size_t frameSize = context.frameSize;
+    size_t bins = frameSize / 2 + 1;
+    double sampleRate = context.sampleRate;
+    double q = FILTER_SCALE / (std::pow(2.0, 1.0 / CHROMA_BIN_COUNT) - 1.0);
+
+    std::shared_ptr<const FFT> fft = FFT::getPlan(frameSize);
+    std::vector<float> real(frameSize);
+    std::vector<float> imaginary(frameSize);
+    std::vector<std::complex<float>> realSpectrum(bins);
+    std::vector<std::complex<float>> imaginarySpectrum(bins);
+    std::vector<std::complex<float>> kernel(bins);
+
+    pitchClass.clear();
+    firstBin.clear();
+    weightStart.clear();
+    weights.clear();
+    for (int note = MIN_NOTE; note <= MAX_NOTE; ++note) {
+        double frequency = 440.0 * std::pow(2.0, (note - 69) / 12.0);
+        if (frequency >= sampleRate * 0.45) {
+            break;
+        }
+
+        // Hann-windowed complex exponential, Q periods long, centred in the frame
+        size_t length = std::min(frameSize, static_cast<size_t>(std::lround(q * sampleRate / frequency)));
+        size_t offset = (frameSize - length) / 2;
+        std::fill(real.begin(), real.end(), 0.0f);
+        std::fill(imaginary.begin(), imaginary.end(), 0.0f);
+        for (size_t n = 0; n < length; ++n) {
+            double window = 0.5 * (1.0 - std::cos(2.0 * M_PI * n / length)) / length;
+            double phase = 2.0 * M_PI * frequency * n / sampleRate;
+            real[offset + n] = static_cast<float>(window * std::cos(phase));
+            imaginary[offset + n] = static_cast<float>(window * std::sin(phase));
+        }
+
+        // Positive-frequency spectrum of the complex kernel from two real FFTs
+        fft->forwardReal(real.data(), realSpectrum.data());
+        fft->forwardReal(imaginary.data(), imaginarySpectrum.data());
+        float peak = 0.0f;
+        for (size_t b = 0; b < bins; ++b) {
+            kernel[b] = realSpectrum[b] + std::complex<float>(0.0f, 1.0f) * imaginarySpectrum[b];
+            peak = std::max(peak, std::abs(kernel[b]));
+        }
+
+        // Keep the contiguous run of bins above the threshold
+        size_t first = bins;
+        size_t last = 0;
+        for (size_t b = 0; b < bins; ++b) {
+            if (std::abs(kernel[b]) >= KERNEL_THRESHOLD * peak) {
+                first = std::min(first, b);
+                last = b + 1;
+            }
+        }
+        pitchClass.push_back(note % static_cast<int>(CHROMA_BIN_COUNT));
+        firstBin.push_back(first);
+        weightStart.push_back(weights.size());
+        for (size_t b = first; b < last; ++b) {
+            weights.push_back(kernel[b].real());
+            weights.push_back(-kernel[b].imag());
+        }
+    }
+    weightStart.push_back(weights.size());
+    return CHROMA_BIN_COUNT;
+}
+
+void ChromaNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    const float* spectrum = inputs[0].data();
+    std::fill(output.begin(), output.end(), 0.0f);
+
+    for (size_t k = 0; k < pitchClass.size(); ++k) {
+        // Complex dot product of the spectrum with the conjugated kernel
+        const float* bins = spectrum + 2 * firstBin[k];
+        const float* kernel = weights.data() + weightStart[k];
+        size_t count = (weightStart[k + 1] - weightStart[k]) / 2;
+        float re = 0.0f;
+        float im = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            float xr = bins[2 * i];
+            float xi = bins[2 * i + 1];
+            float kr = kernel[2 * i];
+            float ki = kernel[2 * i + 1];
+            re += xr * kr - xi * ki;
+            im += xr * ki + xi * kr;
+        }
+        output[pitchClass[k]] += re * re + im * im;
+    }
+
+    float loudest = *std::max_element(output.begin(), output.end());
+    if (loudest > 1e-12f) {
+        for (float& value : output) {
+            value /= loudest;
+        }
+    }
+}
+
+size_t KeyNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    for (size_t key = 0; key < KEY_COUNT; ++key) {
+        const float* profile = key < CHROMA_BIN_COUNT ? MAJOR_PROFILE : MINOR_PROFILE;
+        size_t tonic = key % CHROMA_BIN_COUNT;
+        for (size_t i = 0; i < CHROMA_BIN_COUNT; ++i) {
+            templates[key][(tonic + i) % CHROMA_BIN_COUNT] = profile[i];
+        }
+        standardise(templates[key].data(), CHROMA_BIN_COUNT);
+    }
+    double hopSeconds = static_cast<double>(context.hopSize) / context.sampleRate;
+    decay = static_cast<float>(std::exp(-hopSeconds / DECAY_SECONDS));
+    reset();
+    return 2;
+}
+
+void KeyNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    std::span<const float> chroma = inputs[0];
+    for (size_t i = 0; i < CHROMA_BIN_COUNT; ++i) {
+        accumulated[i] = accumulated[i] * decay + chroma[i];
+    }
+
+    // Pearson correlation with each key profile
+    std::array<float, CHROMA_BIN_COUNT> profile = accumulated;
+    output[0] = 0.0f;
+    output[1] = 0.0f;
+    if (!standardise(profile.data(), CHROMA_BIN_COUNT)) {
+        return;
+    }
+    for (size_t key = 0; key < KEY_COUNT; ++key) {
+        float correlation = 0.0f;
+        for (size_t i = 0; i < CHROMA_BIN_COUNT; ++i) {
+            correlation += profile[i] * templates[key][i];
+        }
+        if (correlation > output[1]) {
+            output[0] = static_cast<float>(key);
+            output[1] = correlation;
+        }
+    }
+}
+
+void KeyNode::reset() {
+    accumulated.fill(0.0f);
+}
+
+size_t ChordNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    // Root, third, fifth (and minor seventh) intervals per chord type
+    const int TRIADS[3][4] = { { 0, 4, 7, -1 }, { 0, 3, 7, -1 }, { 0, 4, 7, 10 } };
+
+    templates.assign(CHROMA_BIN_COUNT * PADDED_STATES, 0.0f);
+    for (size_t chord = 0; chord < CHORD_COUNT; ++chord) {
+        const int* intervals = TRIADS[chord / CHROMA_BIN_COUNT];
+        size_t root = chord % CHROMA_BIN_COUNT;
+        size_t notes = intervals[3] < 0 ? 3 : 4;
+        for (size_t i = 0; i < notes; ++i) {
+            size_t pc = (root + intervals[i]) % CHROMA_BIN_COUNT;
+            templates[pc * PADDED_STATES + chord] = 1.0f / std::sqrt(static_cast<float>(notes));
+        }
+    }
+
+    double hopSeconds = static_cast<double>(context.hopSize) / context.sampleRate;
+    lag = std::max<size_t>(1, static_cast<size_t>(std::lround(LAG_SECONDS / hopSeconds)));
+    score.assign(STATE_COUNT, 0.0f);
+    similarity.assign(lag * PADDED_STATES, 0.0f);
+    switched.assign(lag * STATE_COUNT, 0);
+    bestPrevious.assign(lag, 0);
+    reset();
+    return 3;
+}
+
+void ChordNode::reset() {
+    std::fill(score.begin(), score.end(), 0.0f);
+    column = lag - 1;
+    filled = 0;
+    decided = NO_CHORD;
+}
+
+void ChordNode::scoreTemplates(const float* chroma, float* out) const {
+    // Pitch class outer loop so the inner loop runs across chords, four at a time
+    for (size_t state = 0; state < PADDED_STATES; ++state) {
+        out[state] = 0.0f;
+    }
+    for (size_t pc = 0; pc < CHROMA_BIN_COUNT; ++pc) {
+        const float* row = templates.data() + pc * PADDED_STATES;
+#ifdef HARMONY_USE_SSE
+        __m128 weight = _mm_set1_ps(chroma[pc]);
+        for (size_t state = 0; state < PADDED_STATES; state += 4) {
+            __m128 sum = _mm_loadu_ps(out + state);
+            _mm_storeu_ps(out + state, _mm_add_ps(sum, _mm_mul_ps(weight, _mm_loadu_ps(row + state))));
+        }
+#else
+        for (size_t state = 0; state < PADDED_STATES; ++state) {
+            out[state] += chroma[pc] * row[state];
+        }
+#endif
+    }
+}
+
+void ChordNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    // Unit length, so the template scores are cosine similarities; silence stays zero
+    std::array<float, CHROMA_BIN_COUNT> chroma;
+    float sumSquares = 0.0f;
+    for (float value : inputs[0]) {
+        sumSquares += value * value;
+    }
+    float scale = sumSquares > 1e-12f ? 1.0f / std::sqrt(sumSquares) : 0.0f;
+    for (size_t i = 0; i < CHROMA_BIN_COUNT; ++i) {
+        chroma[i] = inputs[0][i] * scale;
+    }
+
+    column = (column + 1) % lag;
+    float* emission = similarity.data() + column * PADDED_STATES;
+    scoreTemplates(chroma.data(), emission);
+    emission[NO_CHORD] = NO_CHORD_SIMILARITY;
+
+    // Viterbi step: each state either stays or is entered from the previous best
+    size_t previous = std::max_element(score.begin(), score.end()) - score.begin();
+    float enter = score[previous] - SWITCH_PENALTY;
+    std::uint8_t* entered = switched.data() + column * STATE_COUNT;
+    for (size_t state = 0; state < STATE_COUNT; ++state) {
+        bool switchHere = filled > 0 && state != previous && enter > score[state];
+        entered[state] = switchHere ? 1 : 0;
+        score[state] = (switchHere ? enter : score[state]) + SHARPNESS * emission[state];
+    }
+    bestPrevious[column] = static_cast<std::uint8_t>(previous);
+    filled = std::min(filled + 1, lag);
+
+    // Keep the scores near zero; only differences matter
+    float best = *std::max_element(score.begin(), score.end());
+    for (float& value : score) {
+        value -= best;
+    }
+
+    output[0] = 0.0f;
+    output[1] = 0.0f;
+    output[2] = 0.0f;
+    if (filled < lag) {
+        return;
+    }
+
+    // Trace the best path back to the oldest column in the ring
+    size_t state = std::max_element(score.begin(), score.end()) - score.begin();
+    size_t slot = column;
+    for (size_t step = 1; step < lag; ++step) {
+        if (switched[slot * STATE_COUNT + state]) {
+            state = bestPrevious[slot];
+        }
+        slot = (slot + lag - 1) % lag;
+    }
+
+    bool changed = state != decided;
+    decided = state;
+    if (decided != NO_CHORD) {
+        output[0] = static_cast<float>(decided + 1);
+        output[1] = std::max(0.0f, similarity[slot * PADDED_STATES + decided]);
+    }
+    output[2] = changed ? 1.0f : 0.0f;
+}
+
+size_t PitchNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    frameSize = context.frameSize;
+    sampleRate = static_cast<float>(context.sampleRate);
+    fft = FFT::getPlan(frameSize);
+
+    // One lag past maxLag is needed for the interpolation
+    size_t window = frameSize / 2;
+    minLag = std::max<size_t>(2, static_cast<size_t>(sampleRate / MAX_FREQUENCY));
+    maxLag = std::min(window - 2, static_cast<size_t>(std::ceil(sampleRate / MIN_FREQUENCY)));
+    if (minLag >= maxLag) {
+        throw std::runtime_error("Frame size too small for pitch tracking");
+    }
+    return 2;
+}
+
+size_t PitchNode::getScratchBytes() const {
+    // Two frames, their spectra, the correlation and the difference function,
+    // each realigned by the arena
+    size_t bins = frameSize / 2 + 1;
+    return 3 * frameSize * sizeof(float) + 2 * bins * sizeof(std::complex<float>) + (maxLag + 2) * sizeof(float)
+         + 6 * FrameArena::ALIGNMENT;
+}
+
+// YIN steps 2-5: d(tau) = e(0) + e(tau) - 2 r(tau) with e(tau) the energy of
+// the window starting at tau and r the correlation of the first window with
+// the one at tau; normalised by its running mean; first dip below THRESHOLD
+// (or the deepest one); parabolic interpolation of the period.
+void PitchNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) {
+    size_t window = frameSize / 2;
+    size_t bins = frameSize / 2 + 1;
+    std::span<float> signal = scratch.allocate<float>(frameSize);
+    std::span<float> head = scratch.allocate<float>(frameSize);
+    std::span<std::complex<float>> signalSpectrum = scratch.allocate<std::complex<float>>(bins);
+    std::span<std::complex<float>> headSpectrum = scratch.allocate<std::complex<float>>(bins);
+    std::span<float> correlation = scratch.allocate<float>(frameSize);
+    std::span<float> difference = scratch.allocate<float>(maxLag + 2);
+
+    double headEnergy = 0.0;
+    for (size_t i = 0; i < frameSize; ++i) {
+        signal[i] = inputs.samples[i] / 32768.0f;
+        head[i] = i < window ? signal[i] : 0.0f;
+        headEnergy += static_cast<double>(head[i]) * head[i];
+    }
+    if (headEnergy < MIN_LEVEL * window) {
+        output[0] = 0.0f;
+        output[1] = 0.0f;
+        return;
+    }
+
+    // r(tau) = sum over j < window of head[j] * signal[j + tau]. With head
+    // zero past the window, the circular correlation of the two frames has
+    // no wrap-around for tau < window.
+    fft->forwardReal(signal.data(), signalSpectrum.data());
+    fft->forwardReal(head.data(), headSpectrum.data());
+    for (size_t b = 0; b < bins; ++b) {
+        std::complex<float> h = headSpectrum[b];
+        std::complex<float> x = signalSpectrum[b];
+        headSpectrum[b] = std::complex<float>(h.real() * x.real() + h.imag() * x.imag(),
+                                              h.real() * x.imag() - h.imag() * x.real());
+    }
+    fft->inverseReal(headSpectrum.data(), correlation.data());
+
+    // Cumulative mean normalised difference, in place
+    double lagEnergy = headEnergy;
+    double sum = 0.0;
+    difference[0] = 1.0f;
+    for (size_t tau = 1; tau <= maxLag + 1; ++tau) {
+        double leaving = signal[tau - 1];
+        double entering = signal[tau + window - 1];
+        lagEnergy += entering * entering - leaving * leaving;
+        double d = std::max(0.0, headEnergy + lagEnergy - 2.0 * correlation[tau]);
+        sum += d;
+        difference[tau] = sum > 0.0 ? static_cast<float>(d * tau / sum) : 1.0f;
+    }
+
+    size_t best = 0;
+    for (size_t tau = minLag; tau <= maxLag; ++tau) {
+        if (difference[tau] < THRESHOLD) {
+            while (tau < maxLag && difference[tau + 1] < difference[tau]) {
+                ++tau;
+            }
+            best = tau;
+            break;
+        }
+        if (best == 0 || difference[tau] < difference[best]) {
+            best = tau;
+        }
+    }
+
+    float previous = difference[best - 1];
+    float current = difference[best];
+    float next = difference[best + 1];
+    float curvature = previous - 2.0f * current + next;
+    float shift = curvature > 0.0f ? std::clamp(0.5f * (previous - next) / curvature, -0.5f, 0.5f) : 0.0f;
+
+    output[0] = current <= VOICED_LIMIT ? sampleRate / (best + shift) : 0.0f;
+    output[1] = std::clamp(1.0f - current, 0.0f, 1.0f);
+}
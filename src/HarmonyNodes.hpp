@@ -0,0 +1,140 @@
+// HarmonyNodes.hpp
+#ifndef HARMONY_NODES_HPP
+#define HARMONY_NODES_HPP
+
+#include "FFT.hpp"
+#include "FeatureGraph.hpp"
+#include "FeatureSnapshot.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Pitch-based analysis nodes:
+//   chroma  CHROMA_BIN_COUNT pitch-class energies (C, C#, ... B), loudest = 1
+//   key     [key index, correlation]; 0-11 = C..B major, 12-23 = C..B minor
+//   chord   [chord + 1 (0 = no chord), confidence, 1 on the hop the chord changes];
+//           chord 0-11 = C..B major, 12-23 = minor, 24-35 = dominant seventh
+//   pitch   [f0 Hz (0 = unvoiced), confidence 0-1] of the strongest periodicity
+
+// Constant-Q transform folded into pitch classes. The CQT kernels (one
+// windowed complex exponential per semitone, Brown & Puckette) are
+// transformed to the frequency domain once in prepare(); only their
+// significant bins are kept, so each frame costs one short complex dot
+// product per semitone on the existing FFT output. Low notes whose ideal
+// window is longer than the frame are clamped to the frame and smear into
+// their neighbours; larger frame sizes sharpen them.
+class ChromaNode : public FeatureNode {
+private:
+    static const int MIN_NOTE = 36;        // C2, MIDI numbering
+    static const int MAX_NOTE = 95;        // B6
+    static const float KERNEL_THRESHOLD;   // Relative to each kernel's peak
+    static const double FILTER_SCALE;      // Kernel length in units of the minimal constant-Q window
+
+    std::vector<int> pitchClass;           // Per kernel
+    std::vector<size_t> firstBin;          // Per kernel
+    std::vector<size_t> weightStart;       // Per kernel, into weights (plus end marker)
+    std::vector<float> weights;            // Conjugated kernel, interleaved re/im
+
+public:
+    const char* getName() const override { return "chroma"; }
+    FrameResolution getResolution() const override { return FrameResolution::Tonal; }
+    std::vector<std::string> getInputs() const override { return { "fft" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+};
+
+// Streaming key estimate: chroma is accumulated with an exponential decay
+// (a few tens of seconds of memory) and correlated against the 24 rotated
+// Krumhansl-Kessler major and minor key profiles.
+class KeyNode : public FeatureNode {
+private:
+    static const size_t KEY_COUNT = 24;
+    static const float DECAY_SECONDS;
+    static const float SETTLE_DECAYS;        // Decay times until older chroma no longer counts
+
+    std::array<std::array<float, CHROMA_BIN_COUNT>, KEY_COUNT> templates{};  // Zero mean, unit length
+    std::array<float, CHROMA_BIN_COUNT> accumulated{};
+    float decay = 1.0f;
+
+public:
+    const char* getName() const override { return "key"; }
+    FrameResolution getResolution() const override { return FrameResolution::Tonal; }
+    std::vector<std::string> getInputs() const override { return { "chroma" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+    double getSettleSeconds() const override { return DECAY_SECONDS * SETTLE_DECAYS; }
+};
+
+// Chord recognition: chroma is scored against the chord templates (cosine
+// similarity) and smoothed by an HMM that favours staying on the current
+// chord. Decoding is fixed-lag Viterbi: each hop extends the trellis by one
+// column and the best path is traced back LAG_SECONDS to settle the chord at
+// that point, so decisions never wait longer than the lag. Switching to any
+// other chord costs the same, which reduces each Viterbi step to O(states).
+class ChordNode : public FeatureNode {
+private:
+    static const size_t CHORD_COUNT = 36;
+    static const size_t NO_CHORD = CHORD_COUNT;          // Extra state for silence and noise
+    static const size_t STATE_COUNT = CHORD_COUNT + 1;
+    static const size_t PADDED_STATES = 40;              // Multiple of 4 for the emission kernel
+    static const float LAG_SECONDS;
+    static const float SHARPNESS;                        // Log-likelihood per unit of similarity
+    static const float NO_CHORD_SIMILARITY;              // Similarity the no-chord state scores
+    static const float SWITCH_PENALTY;                   // Log-likelihood cost of a chord change
+
+    // Unit-length templates, pitch class major: templates[pc * PADDED_STATES + state]
+    std::vector<float> templates;
+
+    std::vector<float> score;                // Viterbi log-likelihood per state
+    std::vector<float> similarity;           // lag x PADDED_STATES ring of emission similarities
+    std::vector<std::uint8_t> switched;      // lag x STATE_COUNT ring: 1 if the state was entered from bestPrevious
+    std::vector<std::uint8_t> bestPrevious;  // Per ring slot: best state of the column before it
+    size_t lag = 1;
+    size_t column = 0;                       // Ring slot of the newest column
+    size_t filled = 0;
+    size_t decided = NO_CHORD;
+
+    // Template similarities of a unit-length chroma vector, PADDED_STATES floats
+    void scoreTemplates(const float* chroma, float* out) const;
+
+public:
+    const char* getName() const override { return "chord"; }
+    FrameResolution getResolution() const override { return FrameResolution::Tonal; }
+    std::vector<std::string> getInputs() const override { return { "chroma" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+};
+
+// YIN fundamental frequency estimate (de Cheveigne & Kawahara) of the raw
+// frame. The difference function d(tau) between the first half of the frame
+// and its shifted copies is built from running energies and one
+// autocorrelation, which comes from an FFT product instead of a lag loop, so
+// a frame costs O(N log N) rather than O(N^2). Lags stop at half the frame:
+// the lowest pitch found is about 2 * sampleRate / frameSize, so bass lines
+// want the long tonal frames.
+class PitchNode : public FeatureNode {
+private:
+    static const float MIN_FREQUENCY;
+    static const float MAX_FREQUENCY;
+    static const float THRESHOLD;        // First dip of the normalised difference below this is taken
+    static const float VOICED_LIMIT;     // Normalised difference above which the frame is unvoiced
+    static const float MIN_LEVEL;        // Mean square below which the frame is silent
+
+    std::shared_ptr<const FFT> fft;      // Shared with the fft node of the same size
+    size_t frameSize = 0;
+    size_t minLag = 0;
+    size_t maxLag = 0;
+    float sampleRate = 0.0f;
+
+public:
+    const char* getName() const override { return "pitch"; }
+    FrameResolution getResolution() const override { return FrameResolution::Tonal; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    size_t getScratchBytes() const override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+};
+
+#endif // HARMONY_NODES_HPP
@@ -0,0 +1,125 @@
+// InputAnalyzer.cpp
+#include "InputAnalyzer.hpp"
+#include "AllocationTracker.hpp"
+#include <stdexcept>
+
+InputAnalyzer::InputAnalyzer(std::unique_ptr<InputSource> source, const AnalysisConfig& config, FeatureBus& bus)
+    : source(std::move(source))
+    , bus(bus)
+    , sampleRate(config.sampleRate)
+    , running(false)
+    , lastSamplesAt(0)
+    , hopsProcessed(0)
+{
+    unsigned int channels = this->source->getChannelCount();
+    unsigned int inputRate = this->source->getSampleRate(config.sampleRate);
+    const std::string& label = this->source->getConfig().label;
+    // File inputs bring their own rate, which validate() has not seen
+    if (!Resampler::canConvert(inputRate, config.getAnalysisRate())) {
+        throw std::runtime_error("Input '" + label + "' runs at " + std::to_string(inputRate) + " Hz, which cannot be "
+                                 "resampled to the " + std::to_string(config.getAnalysisRate()) + " Hz analysis rate; "
+                                 "convert the file to a standard rate");
+    }
+
+    for (unsigned int c = 0; c < channels; ++c) {
+        // Track recognition and following only run on the primary channel, which drives the lighting
+        AnalysisConfig channelConfig = config;
+        if (bus.getChannelCount() > 0) {
+            channelConfig.fingerprintIndex.clear();
+            channelConfig.followTimeline.clear();
+        }
+        pipelines.push_back(std::make_unique<AnalysisPipeline>(channelConfig, inputRate));
+        busSlots.push_back(bus.addChannel(channels == 1 ? label : label + "." + std::to_string(c + 1)));
+        channelSamples.emplace_back();
+        channelSamples.back().reserve(inputRate);
+    }
+    incoming.reserve(inputRate * channels);
+}
+
+InputAnalyzer::~InputAnalyzer() {
+    stop();
+}
+
+bool InputAnalyzer::start(std::string& error) {
+    if (!source->start(sampleRate, error)) {
+        return false;
+    }
+
+    lastSamplesAt = std::chrono::steady_clock::now().time_since_epoch().count();
+    running = true;
+    worker = std::thread(&InputAnalyzer::run, this);
+    return true;
+}
+
+void InputAnalyzer::stop() {
+    if (running) {
+        running = false;
+        source->getQueue().notify();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    source->stop();
+}
+
+std::chrono::duration<double> InputAnalyzer::getTimeSinceSamples() const {
+    std::chrono::steady_clock::time_point last{ std::chrono::steady_clock::duration(lastSamplesAt.load()) };
+    return std::chrono::steady_clock::now() - last;
+}
+
+void InputAnalyzer::run() {
+    const size_t channels = pipelines.size();
+
+    while (running) {
+        source->getQueue().waitAndDrain(incoming, std::chrono::milliseconds(50));
+        if (incoming.empty()) {
+            continue;
+        }
+        lastSamplesAt = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        // Split interleaved frames into one stream per channel
+        size_t frames = incoming.size() / channels;
+        for (size_t c = 0; c < channels; ++c) {
+            std::vector<std::int16_t>& samples = channelSamples[c];
+            samples.resize(frames);
+            for (size_t i = 0; i < frames; ++i) {
+                samples[i] = incoming[i * channels + c];
+            }
+        }
+
+        // After warm-up the hot loop must not allocate; debug builds trap if it does
+        if (hopsProcessed >= WARMUP_HOPS) {
+            AllocationTracker::arm(true);
+        }
+        for (size_t c = 0; c < channels; ++c) {
+            analyseChannel(c);
+        }
+        AllocationTracker::disarm();
+    }
+}
+
+void InputAnalyzer::analyseChannel(size_t channel) {
+    AnalysisPipeline& pipeline = *pipelines[channel];
+    const std::vector<std::int16_t>& samples = channelSamples[channel];
+
+    // Analyse every complete hop that has arrived, then publish the latest
+    // result along with any pulse an earlier hop of the batch produced
+    const std::int16_t* pending = samples.data();
+    size_t remaining = samples.size();
+    bool produced = false;
+    while (remaining > 0) {
+        size_t accepted = pipeline.pushSamples(pending, remaining);
+        pending += accepted;
+        remaining -= accepted;
+        while (pipeline.processHop()) {
+            produced = true;
+            if (channel == 0) {
+                ++hopsProcessed;
+            }
+        }
+    }
+
+    if (produced) {
+        bus.publish(busSlots[channel], pipeline.collectSnapshot());
+    }
+}
@@ -0,0 +1,57 @@
+// InputAnalyzer.hpp
+#ifndef INPUT_ANALYZER_HPP
+#define INPUT_ANALYZER_HPP
+
+#include "AnalysisConfig.hpp"
+#include "AnalysisPipeline.hpp"
+#include "FeatureBus.hpp"
+#include "InputSource.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Analysis of one input on its own worker thread, so several inputs run in
+// parallel on separate cores. Interleaved capture is split per channel and
+// each channel has its own pipeline, publishing into the shared FeatureBus.
+class InputAnalyzer {
+private:
+    static const size_t WARMUP_HOPS = 16;  // Hops before the allocation tracker arms
+
+    std::unique_ptr<InputSource> source;
+    std::vector<std::unique_ptr<AnalysisPipeline>> pipelines;
+    std::vector<size_t> busSlots;
+    FeatureBus& bus;
+    unsigned int sampleRate;
+
+    std::vector<std::int16_t> incoming;
+    std::vector<std::vector<std::int16_t>> channelSamples;
+
+    std::thread worker;
+    std::atomic<bool> running;
+    std::atomic<std::int64_t> lastSamplesAt;  // steady_clock ticks
+    size_t hopsProcessed;
+
+    void run();
+    void analyseChannel(size_t channel);
+
+public:
+    InputAnalyzer(std::unique_ptr<InputSource> source, const AnalysisConfig& config, FeatureBus& bus);
+    ~InputAnalyzer();
+
+    InputAnalyzer(const InputAnalyzer&) = delete;
+    InputAnalyzer& operator=(const InputAnalyzer&) = delete;
+
+    bool start(std::string& error);
+    void stop();
+
+    const std::string& getLabel() const { return source->getConfig().label; }
+
+    // How long since the source last delivered samples
+    std::chrono::duration<double> getTimeSinceSamples() const;
+};
+
+#endif // INPUT_ANALYZER_HPP
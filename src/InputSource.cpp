@@ -0,0 +1,104 @@
+// InputSource.cpp
+#include "InputSource.hpp"
+#include <algorithm>
+#include <chrono>
+
+InputSource::InputSource(const InputConfig& config)
+    : config(config)
+{
+}
+
+std::unique_ptr<InputSource> InputSource::create(const InputConfig& config) {
+    if (config.kind == InputKind::File) {
+        return std::make_unique<FileInput>(config);
+    }
+    return std::make_unique<DeviceInput>(config);
+}
+
+DeviceInput::DeviceInput(const InputConfig& config)
+    : InputSource(config)
+    , recorder(queue)
+{
+}
+
+bool DeviceInput::start(unsigned int sampleRate, std::string& error) {
+    std::string device = config.device.empty() ? sf::SoundRecorder::getDefaultDevice() : config.device;
+
+    // Try to set up the audio device
+    if (!recorder.setDevice(device)) {
+        error = "Failed to set up the audio device '" + device + "' for input '" + config.label + "'.\n"
+            "Please check your audio settings.";
+        return false;
+    }
+
+    recorder.setChannelCount(config.channelCount);
+
+    // Start the recorder at the configured rate. OpenAL either captures at
+    // exactly this rate or fails, so the pipeline can rely on it.
+    if (!recorder.start(sampleRate)) {
+        error = "Failed to start audio recorder for input '" + config.label + "' at "
+            + std::to_string(sampleRate) + " Hz.\n"
+            "Please check your microphone permissions and that\n"
+            "sample_rate in analysis.cfg is supported by the device.";
+        return false;
+    }
+    return true;
+}
+
+void DeviceInput::stop() {
+    recorder.stop();
+}
+
+FileInput::FileInput(const InputConfig& config)
+    : InputSource(config)
+    , loaded(false)
+    , running(false)
+{
+    loaded = wav.load(config.path);
+}
+
+FileInput::~FileInput() {
+    stop();
+}
+
+bool FileInput::start(unsigned int, std::string& error) {
+    // Files play at their own rate; the analysis pipeline resamples them
+    if (!loaded) {
+        error = "Input '" + config.label + "': " + wav.getError();
+        return false;
+    }
+    if (wav.getFrameCount() == 0) {
+        error = "Input '" + config.label + "': " + config.path + " contains no audio";
+        return false;
+    }
+
+    running = true;
+    pacer = std::thread(&FileInput::run, this);
+    return true;
+}
+
+void FileInput::stop() {
+    running = false;
+    if (pacer.joinable()) {
+        pacer.join();
+    }
+}
+
+void FileInput::run() {
+    using Clock = std::chrono::steady_clock;
+
+    const std::vector<std::int16_t>& samples = wav.getSamples();
+    const size_t channels = wav.getChannelCount();
+    const size_t chunkFrames = std::max<size_t>(1, wav.getSampleRate() / 100);  // 10 ms
+
+    size_t position = 0;  // In frames
+    Clock::time_point next = Clock::now();
+    while (running) {
+        size_t frames = std::min(chunkFrames, wav.getFrameCount() - position);
+        queue.push(samples.data() + position * channels, frames * channels);
+        position = (position + frames) % wav.getFrameCount();
+
+        next += std::chrono::microseconds(frames * 1000000 / wav.getSampleRate());
+        std::this_thread::sleep_until(next);
+    }
+}
@@ -0,0 +1,74 @@
+// InputSource.hpp
+#ifndef INPUT_SOURCE_HPP
+#define INPUT_SOURCE_HPP
+
+#include "AnalysisConfig.hpp"
+#include "CaptureStream.hpp"
+#include "SampleQueue.hpp"
+#include "WavReader.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Something that delivers interleaved 16-bit samples into a SampleQueue from
+// its own thread: a capture device or a WAV file played back in real time.
+class InputSource {
+protected:
+    InputConfig config;
+    SampleQueue queue;
+
+public:
+    explicit InputSource(const InputConfig& config);
+    virtual ~InputSource() = default;
+
+    InputSource(const InputSource&) = delete;
+    InputSource& operator=(const InputSource&) = delete;
+
+    // Returns false with a user-facing description in error
+    virtual bool start(unsigned int sampleRate, std::string& error) = 0;
+    virtual void stop() = 0;
+
+    virtual unsigned int getChannelCount() const { return config.channelCount; }
+
+    // Rate the samples will arrive at when requestedRate is asked for
+    virtual unsigned int getSampleRate(unsigned int requestedRate) const { return requestedRate; }
+    const InputConfig& getConfig() const { return config; }
+    SampleQueue& getQueue() { return queue; }
+
+    static std::unique_ptr<InputSource> create(const InputConfig& config);
+};
+
+class DeviceInput : public InputSource {
+private:
+    CaptureStream recorder;
+
+public:
+    explicit DeviceInput(const InputConfig& config);
+
+    bool start(unsigned int sampleRate, std::string& error) override;
+    void stop() override;
+};
+
+// Loops a WAV file, pushing 10 ms chunks paced against the wall clock.
+// The file is loaded on construction so its channel count is known up front.
+class FileInput : public InputSource {
+private:
+    WavReader wav;
+    bool loaded;
+    std::thread pacer;
+    std::atomic<bool> running;
+
+    void run();
+
+public:
+    explicit FileInput(const InputConfig& config);
+    ~FileInput();
+
+    bool start(unsigned int sampleRate, std::string& error) override;
+    void stop() override;
+    unsigned int getChannelCount() const override { return loaded ? wav.getChannelCount() : 1; }
+    unsigned int getSampleRate(unsigned int requestedRate) const override { return loaded ? wav.getSampleRate() : requestedRate; }
+};
+
+#endif // INPUT_SOURCE_HPP
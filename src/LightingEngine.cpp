@@ -0,0 +1,68 @@
+// LightingEngine.cpp
+#include "LightingEngine.hpp"
+#include <algorithm>
+#include <cmath>
+
+const double LightingEngine::SCENE_HUE_STEP = 0.382;   // Golden section: successive scenes stay far apart
+const double LightingEngine::BREAKDOWN_SATURATION = 0.5;
+
+LightingEngine::LightingEngine(size_t washAddress, size_t strobeAddress)
+    : washAddress(washAddress)
+    , strobeAddress(strobeAddress)
+    , washColor{ 0, 0, 0 }
+    , sceneHue(0.0)
+    , lastHopTime(-1.0)
+{
+}
+
+double LightingEngine::keyHue(float key) {
+    // Minor keys share the colour of their relative major; neighbouring keys on
+    // the circle of fifths get neighbouring hues, so modulations shift gently
+    int tonic = static_cast<int>(key) % 12;
+    int major = key >= 12.0f ? (tonic + 3) % 12 : tonic;
+    int fifths = (major * 7) % 12;
+    return fifths / 12.0;
+}
+
+double LightingEngine::chordHue(float chord) {
+    // Chords take the colour of the key they are the tonic chord of; sevenths
+    // count as major
+    int index = static_cast<int>(chord) - 1;
+    int root = index % 12;
+    return keyHue(static_cast<float>(index / 12 == 1 ? 12 + root : root));
+}
+
+void LightingEngine::render(const FeatureSnapshot& snapshot, DmxFrame& frame) {
+    // Pulses are acted on once per hop, however often the display renders it
+    bool newHop = snapshot.time != lastHopTime;
+    lastHopTime = snapshot.time;
+
+    // Map the current chord, else the key, else the centroid to hue, and
+    // volume to brightness (full saturation for vibrant colors, except in breakdowns)
+    double hue = snapshot.centroid;
+    if (snapshot.chord > 0.0f) {
+        hue = chordHue(snapshot.chord);
+    }
+    else if (snapshot.keyStrength > 0.0f) {
+        hue = keyHue(snapshot.key);
+    }
+    // Section changes rotate the palette, so a new scene reads as new even in the same key
+    if (newHop && snapshot.sectionChange > 0.0f) {
+        sceneHue = std::fmod(sceneHue + SCENE_HUE_STEP, 1.0);
+    }
+    hue = std::fmod(hue + sceneHue, 1.0);
+    double saturation = static_cast<int>(snapshot.section) == SECTION_BREAKDOWN ? BREAKDOWN_SATURATION : 1.0;
+    washColor = HSVtoRGB(hue, saturation, snapshot.volume);
+
+    size_t base = washAddress - 1;
+    frame.channels[base + 0] = washColor.r;
+    frame.channels[base + 1] = washColor.g;
+    frame.channels[base + 2] = washColor.b;
+    frame.channels[base + 3] = 255;  // Dimmer fully open, colour carries brightness
+    frame.usedChannels = std::max(frame.usedChannels, base + 4);
+
+    if (strobeAddress > 0) {
+        frame.channels[strobeAddress - 1] = static_cast<std::uint8_t>(std::lround(snapshot.strobe * 255.0f));
+        frame.usedChannels = std::max(frame.usedChannels, strobeAddress);
+    }
+}
@@ -0,0 +1,54 @@
+// LightingEngine.hpp
+#ifndef LIGHTING_ENGINE_HPP
+#define LIGHTING_ENGINE_HPP
+
+#include "ColorConversion.hpp"
+#include "FeatureSnapshot.hpp"
+#include <array>
+#include <cstdint>
+
+static const size_t DMX_UNIVERSE_SIZE = 512;
+
+// One DMX universe. usedChannels marks how much of it the current patch
+// drives, so logs and outputs can skip the untouched tail.
+struct DmxFrame {
+    std::array<std::uint8_t, DMX_UNIVERSE_SIZE> channels{};
+    size_t usedChannels = 0;
+};
+
+// Maps analysis features onto fixture channels. Patches an RGB wash fixture,
+// where spectral centroid drives hue and volume drives brightness, and
+// optionally a single-channel strobe driven by the percussive level.
+// When the chord or key features are computed, the current chord (or else
+// the detected key) drives hue instead. With the sections feature, every
+// section change moves the whole palette to a new scene, and breakdowns are
+// washed out.
+class LightingEngine {
+private:
+    static const double SCENE_HUE_STEP;
+    static const double BREAKDOWN_SATURATION;
+
+    // 1-based DMX start address of the wash fixture (R, G, B, dimmer)
+    size_t washAddress;
+    size_t strobeAddress;    // 1-based intensity channel, 0 when no strobe is patched
+    RGBColor washColor;
+    double sceneHue;         // Palette offset, moved on every section change
+    double lastHopTime;      // Snapshot time of the last render, -1 before the first
+
+    // Hue (0-1) for a key index as published by the key feature
+    static double keyHue(float key);
+    // Same for a chord as published by the chord feature (1-based)
+    static double chordHue(float chord);
+
+public:
+    explicit LightingEngine(size_t washAddress = 1, size_t strobeAddress = 0);
+
+    // May be called more often than hops are analysed; the same snapshot
+    // rendered again does not repeat its pulses
+    void render(const FeatureSnapshot& snapshot, DmxFrame& frame);
+
+    // Colour of the wash fixture from the last render, for on-screen preview
+    RGBColor getPreviewColor() const { return washColor; }
+};
+
+#endif // LIGHTING_ENGINE_HPP
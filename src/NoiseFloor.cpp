@@ -0,0 +1,65 @@
+// NoiseFloor.cpp
+#include "NoiseFloor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+const double NoiseFloor::SMOOTHING_SECONDS = 0.1;
+
+NoiseFloor::NoiseFloor(size_t laneCount, double hopSeconds, double windowSeconds, float bias)
+    : laneCount(laneCount)
+    , subwindowHops(std::max<size_t>(1, static_cast<size_t>(std::ceil(windowSeconds / hopSeconds / SUBWINDOW_COUNT))))
+    , smoothing(static_cast<float>(std::exp(-hopSeconds / SMOOTHING_SECONDS)))
+    , bias(bias)
+    , smoothed(laneCount)
+    , current(laneCount)
+    , subwindows(SUBWINDOW_COUNT * laneCount)
+    , windowMin(laneCount)
+    , floor(laneCount)
+    , hopsInSubwindow(0)
+    , nextSubwindow(0)
+    , started(false)
+{
+    reset();
+}
+
+void NoiseFloor::reset() {
+    // Empty sub-windows never win the minimum
+    const float none = std::numeric_limits<float>::max();
+    std::fill(smoothed.begin(), smoothed.end(), 0.0f);
+    std::fill(current.begin(), current.end(), none);
+    std::fill(subwindows.begin(), subwindows.end(), none);
+    std::fill(windowMin.begin(), windowMin.end(), none);
+    std::fill(floor.begin(), floor.end(), 0.0f);
+    hopsInSubwindow = 0;
+    nextSubwindow = 0;
+    started = false;
+}
+
+void NoiseFloor::update(const float* power) {
+    // The first hop seeds the smoothing instead of rising from zero
+    float keep = started ? smoothing : 0.0f;
+    started = true;
+    for (size_t lane = 0; lane < laneCount; ++lane) {
+        smoothed[lane] = keep * smoothed[lane] + (1.0f - keep) * power[lane];
+        current[lane] = std::min(current[lane], smoothed[lane]);
+        floor[lane] = bias * std::min(windowMin[lane], current[lane]);
+    }
+
+    if (++hopsInSubwindow < subwindowHops) {
+        return;
+    }
+
+    // Close the sub-window: it replaces the oldest one
+    std::copy(current.begin(), current.end(), subwindows.begin() + nextSubwindow * laneCount);
+    nextSubwindow = (nextSubwindow + 1) % SUBWINDOW_COUNT;
+    hopsInSubwindow = 0;
+    std::copy(subwindows.begin(), subwindows.begin() + laneCount, windowMin.begin());
+    for (size_t s = 1; s < SUBWINDOW_COUNT; ++s) {
+        const float* minima = subwindows.data() + s * laneCount;
+        for (size_t lane = 0; lane < laneCount; ++lane) {
+            windowMin[lane] = std::min(windowMin[lane], minima[lane]);
+        }
+    }
+    std::fill(current.begin(), current.end(), std::numeric_limits<float>::max());
+}
@@ -0,0 +1,53 @@
+// NoiseFloor.hpp
+#ifndef NOISE_FLOOR_HPP
+#define NOISE_FLOOR_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Minimum-statistics noise estimate (Martin 2001) for a set of power values
+// ("lanes": one per frequency bin, or a single broadband level). Each lane is
+// smoothed over SMOOTHING_SECONDS, and the floor is the smallest smoothed value
+// of the last windowSeconds times a bias, since the minimum of a noisy
+// estimate sits below its mean. Music rarely stays quiet for long, so with a
+// window longer than a song the minimum is the room noise between songs.
+// The window is kept as SUBWINDOW_COUNT sub-window minima: an update costs
+// O(lanes), the floor follows a drop in the noise within the smoothing time
+// and a rise within one window.
+class NoiseFloor {
+private:
+    static const size_t SUBWINDOW_COUNT = 8;
+
+    size_t laneCount;
+    size_t subwindowHops;
+    float smoothing;                 // Weight of the previous smoothed power
+    float bias;
+
+    std::vector<float> smoothed;
+    std::vector<float> current;      // Minimum of the running sub-window
+    std::vector<float> subwindows;   // SUBWINDOW_COUNT x laneCount finished sub-window minima
+    std::vector<float> windowMin;    // Minimum of the finished sub-windows
+    std::vector<float> floor;
+    size_t hopsInSubwindow;
+    size_t nextSubwindow;
+    bool started;
+
+public:
+    static const double SMOOTHING_SECONDS;
+
+    // bias scales the minimum up to the mean noise power; it depends on how
+    // much the smoothed power of each lane fluctuates
+    NoiseFloor(size_t laneCount, double hopSeconds, double windowSeconds, float bias);
+
+    void reset();
+
+    // Adds one hop of laneCount power values
+    void update(const float* power);
+
+    // Estimated noise power per lane; 0 before the first update
+    float getFloor(size_t lane) const { return floor[lane]; }
+    const float* getFloors() const { return floor.data(); }
+    size_t getLaneCount() const { return laneCount; }
+};
+
+#endif // NOISE_FLOOR_HPP
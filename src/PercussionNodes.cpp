@@ -0,0 +1,345 @@
+// PercussionNodes.cpp
+#define _USE_MATH_DEFINES
+
+#include "PercussionNodes.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define PERCUSSION_USE_SSE 1
+#endif
+
+const float HpssNode::HARMONIC_SECONDS = 0.2f;
+const float HpssNode::PERCUSSIVE_HZ = 700.0f;
+const float DrumNode::BAND_EDGES[BAND_COUNT + 1] = { 30.0f, 120.0f, 5000.0f, 16000.0f };
+const float DrumNode::HISTORY_SECONDS = 0.5f;
+const float DrumNode::REFRACTORY_SECONDS = 0.05f;
+const float DrumNode::SENSITIVITY = 2.0f;
+const float DrumNode::MIN_RISE = 0.3f;
+const float DrumNode::FULL_VELOCITY_RISE = 3.0f;
+const float CrossoverNode::CROSSOVER_HZ[BAND_COUNT - 1] = { 150.0f, 800.0f, 5000.0f };
+const float CrossoverNode::BASELINE_ATTACK_SECONDS = 0.01f;
+const float CrossoverNode::BASELINE_RELEASE_SECONDS = 0.15f;
+const float CrossoverNode::REFRACTORY_SECONDS = 0.05f;
+const float CrossoverNode::HIT_RATIO = 4.0f;        // 6 dB
+const float CrossoverNode::MIN_HIT_LEVEL = 0.01f;   // About -40 dBFS
+const float CrossoverNode::FULL_VELOCITY_DB = 18.0f;
+
+const float DrumNode::PROTOTYPES[DRUM_COUNT][DESCRIPTOR_COUNT] = {
+    { 0.60f, 0.00f, 0.05f },   // Kick: mostly below 120 Hz
+    { 0.10f, 0.20f, 0.45f },   // Snare: body and noise in the mids
+    { 0.00f, 0.90f, 0.95f },   // Hi-hat: almost all above 5 kHz
+};
+
+namespace {
+    struct BiquadCoefficients {
+        float b0, b1, b2, a1, a2;
+    };
+
+    // Butterworth (Q = 1/sqrt 2) sections; two in series make one LR4 slope
+    BiquadCoefficients butterworth(double hz, double rate, bool highPass) {
+        double w0 = 2.0 * M_PI * std::min(hz, 0.45 * rate) / rate;
+        double alpha = std::sin(w0) / std::sqrt(2.0);
+        double c = std::cos(w0);
+        double a0 = 1.0 + alpha;
+        double edge = highPass ? (1.0 + c) / 2.0 : (1.0 - c) / 2.0;
+        return { static_cast<float>(edge / a0), static_cast<float>((highPass ? -2.0 : 2.0) * edge / a0),
+                 static_cast<float>(edge / a0), static_cast<float>(-2.0 * c / a0),
+                 static_cast<float>((1.0 - alpha) / a0) };
+    }
+}
+
+size_t HpssNode::prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) {
+    size_t bins = inputSizes[0];
+    double hopSeconds = static_cast<double>(context.hopSize) / context.sampleRate;
+    double binWidth = static_cast<double>(context.sampleRate) / context.frameSize;
+    size_t frames = std::max<size_t>(3, static_cast<size_t>(std::lround(HARMONIC_SECONDS / hopSeconds)));
+    size_t span = std::max<size_t>(3, static_cast<size_t>(std::lround(PERCUSSIVE_HZ / binWidth)));
+
+    harmonicMedians.assign(bins, SlidingMedian(frames));
+    percussiveMedian = std::make_unique<SlidingMedian>(span);
+    return 2 * bins;
+}
+
+void HpssNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    std::span<const float> magnitudes = inputs[0];
+    size_t bins = magnitudes.size();
+    float* harmonic = output.data();
+    float* percussive = output.data() + bins;
+
+    for (size_t bin = 0; bin < bins; ++bin) {
+        harmonic[bin] = harmonicMedians[bin].push(magnitudes[bin]);
+    }
+
+    // Centred median across bins; the edges are extended with the end values
+    size_t half = percussiveMedian->getSize() / 2;
+    percussiveMedian->reset(magnitudes[0]);
+    for (size_t bin = 0; bin < half; ++bin) {
+        percussiveMedian->push(magnitudes[std::min(bin, bins - 1)]);
+    }
+    for (size_t bin = 0; bin < bins; ++bin) {
+        percussive[bin] = percussiveMedian->push(magnitudes[std::min(bin + half, bins - 1)]);
+    }
+
+    // Soft masks: each bin goes to whichever estimate dominates it, squared
+    for (size_t bin = 0; bin < bins; ++bin) {
+        float h = harmonic[bin] * harmonic[bin];
+        float p = percussive[bin] * percussive[bin];
+        float total = h + p;
+        float harmonicShare = total > 0.0f ? h / total : 0.5f;
+        harmonic[bin] = magnitudes[bin] * harmonicShare;
+        percussive[bin] = magnitudes[bin] * (1.0f - harmonicShare);
+    }
+}
+
+void HpssNode::reset() {
+    for (SlidingMedian& median : harmonicMedians) {
+        median.reset();
+    }
+}
+
+size_t HpssEnergyNode::prepare(const FrameContext&, const std::vector<size_t>&) {
+    return 2;
+}
+
+void HpssEnergyNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    std::span<const float> hpss = inputs[0];
+    size_t bins = hpss.size() / 2;
+    float harmonic = 0.0f;
+    float percussive = 0.0f;
+    for (size_t bin = 0; bin < bins; ++bin) {
+        harmonic += hpss[bin] * hpss[bin];
+        percussive += hpss[bins + bin] * hpss[bins + bin];
+    }
+
+    float rms = inputs[1][0];
+    float total = harmonic + percussive;
+    output[0] = total > 0.0f ? rms * std::sqrt(harmonic / total) : 0.0f;
+    output[1] = total > 0.0f ? rms * std::sqrt(percussive / total) : 0.0f;
+}
+
+size_t DrumNode::prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) {
+    size_t bins = inputSizes[0] / 2;
+    float binWidth = static_cast<float>(context.sampleRate) / context.frameSize;
+    for (size_t edge = 0; edge <= BAND_COUNT; ++edge) {
+        bandBins[edge] = std::min(bins, static_cast<size_t>(std::lround(BAND_EDGES[edge] / binWidth)));
+    }
+    bandBins[0] = std::max<size_t>(1, bandBins[0]);
+
+    float octaves = std::log2(BAND_EDGES[BAND_COUNT] / BAND_EDGES[0]);
+    binOctaves.assign(bins, 0.0f);
+    for (size_t bin = bandBins[0]; bin < bandBins[BAND_COUNT]; ++bin) {
+        binOctaves[bin] = std::clamp(std::log2(bin * binWidth / BAND_EDGES[0]) / octaves, 0.0f, 1.0f);
+    }
+
+    float hopSeconds = static_cast<float>(context.hopSize) / context.sampleRate;
+    size_t historyLength = std::max<size_t>(4, static_cast<size_t>(std::ceil(HISTORY_SECONDS / hopSeconds)));
+    history.assign(historyLength * BAND_COUNT, 0.0f);
+    refractoryHops = std::max<size_t>(1, static_cast<size_t>(std::ceil(REFRACTORY_SECONDS / hopSeconds)));
+
+    // A transient dominates the windowed frame once it reaches the middle
+    hitDelay = 0.5f * context.frameSize / context.sampleRate;
+    reset();
+    return DRUM_COUNT + 1;
+}
+
+void DrumNode::reset() {
+    previousLevel.fill(0.0f);
+    std::fill(history.begin(), history.end(), 0.0f);
+    historyPos = 0;
+    historyFilled = 0;
+    hopsSinceHit = refractoryHops;
+}
+
+void DrumNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    std::span<const float> hpss = inputs[0];
+    const float* percussive = hpss.data() + hpss.size() / 2;
+    std::fill(output.begin(), output.end(), 0.0f);
+
+    std::array<float, BAND_COUNT> energy{};
+    float centroid = 0.0f;
+    for (size_t band = 0; band < BAND_COUNT; ++band) {
+        for (size_t bin = bandBins[band]; bin < bandBins[band + 1]; ++bin) {
+            float binEnergy = percussive[bin] * percussive[bin];
+            energy[band] += binEnergy;
+            centroid += binEnergy * binOctaves[bin];
+        }
+    }
+
+    // Per-band onsets: rise of the log RMS level over a running threshold
+    size_t historyLength = history.size() / BAND_COUNT;
+    float strongest = 0.0f;
+    for (size_t band = 0; band < BAND_COUNT; ++band) {
+        size_t width = std::max<size_t>(1, bandBins[band + 1] - bandBins[band]);
+        float level = std::log1p(std::sqrt(energy[band] / width));
+        float rise = std::max(0.0f, level - previousLevel[band]);
+        previousLevel[band] = level;
+
+        float* ring = history.data() + band * historyLength;
+        float mean = 0.0f;
+        for (size_t i = 0; i < historyFilled; ++i) {
+            mean += ring[i];
+        }
+        mean = historyFilled ? mean / historyFilled : 0.0f;
+        float variance = 0.0f;
+        for (size_t i = 0; i < historyFilled; ++i) {
+            variance += (ring[i] - mean) * (ring[i] - mean);
+        }
+        variance = historyFilled ? variance / historyFilled : 0.0f;
+        ring[historyPos] = rise;
+
+        if (rise > MIN_RISE && rise > mean + SENSITIVITY * std::sqrt(variance)) {
+            strongest = std::max(strongest, rise);
+        }
+    }
+    bool warm = historyFilled == historyLength;
+    historyPos = (historyPos + 1) % historyLength;
+    historyFilled = std::min(historyFilled + 1, historyLength);
+
+    // One hit per refractory period, whichever bands fired
+    ++hopsSinceHit;
+    float total = energy[0] + energy[1] + energy[2];
+    if (strongest <= 0.0f || !warm || hopsSinceHit < refractoryHops || total <= 0.0f) {
+        return;
+    }
+    hopsSinceHit = 0;
+
+    float descriptor[DESCRIPTOR_COUNT] = { energy[0] / total, energy[BAND_COUNT - 1] / total, centroid / total };
+    size_t nearest = 0;
+    float nearestDistance = 0.0f;
+    for (size_t drum = 0; drum < DRUM_COUNT; ++drum) {
+        float distance = 0.0f;
+        for (size_t d = 0; d < DESCRIPTOR_COUNT; ++d) {
+            distance += (descriptor[d] - PROTOTYPES[drum][d]) * (descriptor[d] - PROTOTYPES[drum][d]);
+        }
+        if (drum == 0 || distance < nearestDistance) {
+            nearest = drum;
+            nearestDistance = distance;
+        }
+    }
+    output[nearest] = std::min(1.0f, strongest / FULL_VELOCITY_RISE);
+    output[DRUM_COUNT] = hitDelay;
+}
+
+size_t CrossoverNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    frameSize = context.frameSize;
+    hopSize = context.hopSize;
+    sampleRate = static_cast<float>(context.sampleRate);
+
+    // Band b is high-passed at the crossover below it and low-passed at the
+    // one above; the outer bands pass their open side through unity stages
+    for (size_t band = 0; band < BAND_COUNT; ++band) {
+        BiquadCoefficients stages[STAGE_COUNT];
+        BiquadCoefficients unity = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        stages[0] = stages[1] = band > 0 ? butterworth(CROSSOVER_HZ[band - 1], sampleRate, true) : unity;
+        stages[2] = stages[3] = band + 1 < BAND_COUNT ? butterworth(CROSSOVER_HZ[band], sampleRate, false) : unity;
+        for (size_t stage = 0; stage < STAGE_COUNT; ++stage) {
+            b0[stage][band] = stages[stage].b0;
+            b1[stage][band] = stages[stage].b1;
+            b2[stage][band] = stages[stage].b2;
+            a1[stage][band] = stages[stage].a1;
+            a2[stage][band] = stages[stage].a2;
+        }
+    }
+
+    float blockSeconds = BLOCK_SIZE / sampleRate;
+    attackAlpha = 1.0f - std::exp(-blockSeconds / BASELINE_ATTACK_SECONDS);
+    releaseAlpha = 1.0f - std::exp(-blockSeconds / BASELINE_RELEASE_SECONDS);
+    refractoryBlocks = std::max<size_t>(1, static_cast<size_t>(std::lround(REFRACTORY_SECONDS / blockSeconds)));
+    reset();
+    return BAND_COUNT + 2;
+}
+
+void CrossoverNode::filter(const std::int16_t* samples, size_t count) {
+#ifdef PERCUSSION_USE_SSE
+    __m128 s1[STAGE_COUNT];
+    __m128 s2[STAGE_COUNT];
+    for (size_t stage = 0; stage < STAGE_COUNT; ++stage) {
+        s1[stage] = _mm_load_ps(state1[stage]);
+        s2[stage] = _mm_load_ps(state2[stage]);
+    }
+    __m128 energy = _mm_load_ps(blockEnergy);
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    for (size_t i = 0; i < count; ++i) {
+        __m128 x = _mm_mul_ps(_mm_set1_ps(static_cast<float>(samples[i])), scale);
+        for (size_t stage = 0; stage < STAGE_COUNT; ++stage) {
+            __m128 y = _mm_add_ps(_mm_mul_ps(_mm_load_ps(b0[stage]), x), s1[stage]);
+            s1[stage] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_load_ps(b1[stage]), x), _mm_mul_ps(_mm_load_ps(a1[stage]), y)),
+                                   s2[stage]);
+            s2[stage] = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(b2[stage]), x), _mm_mul_ps(_mm_load_ps(a2[stage]), y));
+            x = y;
+        }
+        energy = _mm_add_ps(energy, _mm_mul_ps(x, x));
+    }
+    for (size_t stage = 0; stage < STAGE_COUNT; ++stage) {
+        _mm_store_ps(state1[stage], s1[stage]);
+        _mm_store_ps(state2[stage], s2[stage]);
+    }
+    _mm_store_ps(blockEnergy, energy);
+#else
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t band = 0; band < BAND_COUNT; ++band) {
+            float x = samples[i] / 32768.0f;
+            for (size_t stage = 0; stage < STAGE_COUNT; ++stage) {
+                float y = b0[stage][band] * x + state1[stage][band];
+                state1[stage][band] = b1[stage][band] * x - a1[stage][band] * y + state2[stage][band];
+                state2[stage][band] = b2[stage][band] * x - a2[stage][band] * y;
+                x = y;
+            }
+            blockEnergy[band] += x * x;
+        }
+    }
+#endif
+}
+
+void CrossoverNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    const std::int16_t* samples = inputs.samples + frameSize - hopSize;
+    float velocity = 0.0f;
+    float delay = 0.0f;
+
+    // Blocks run on across hop boundaries; a hit is judged as its block completes
+    for (size_t pos = 0; pos < hopSize;) {
+        size_t count = std::min(BLOCK_SIZE - blockFill, hopSize - pos);
+        filter(samples + pos, count);
+        pos += count;
+        blockFill += count;
+        if (blockFill < BLOCK_SIZE) {
+            break;
+        }
+
+        for (size_t band = 0; band < BAND_COUNT; ++band) {
+            levels[band] = std::sqrt(blockEnergy[band] / BLOCK_SIZE);
+            blockEnergy[band] = 0.0f;
+        }
+        blockFill = 0;
+
+        float bass = levels[0] * levels[0];
+        ++blocksSinceHit;
+        if (blocksSinceHit >= refractoryBlocks && levels[0] >= MIN_HIT_LEVEL && bass > HIT_RATIO * baseline
+            && velocity == 0.0f) {
+            float rise = 10.0f * std::log10(bass / std::max(baseline, 1e-12f));
+            velocity = std::min(1.0f, rise / FULL_VELOCITY_DB);
+            // From the middle of the block to the end of the hop
+            delay = (hopSize - pos + 0.5f * BLOCK_SIZE) / sampleRate;
+            blocksSinceHit = 0;
+        }
+        baseline += (bass > baseline ? attackAlpha : releaseAlpha) * (bass - baseline);
+    }
+
+    std::copy(levels.begin(), levels.end(), output.begin());
+    output[BAND_COUNT] = velocity;
+    output[BAND_COUNT + 1] = delay;
+}
+
+void CrossoverNode::reset() {
+    for (size_t stage = 0; stage < STAGE_COUNT; ++stage) {
+        std::fill(std::begin(state1[stage]), std::end(state1[stage]), 0.0f);
+        std::fill(std::begin(state2[stage]), std::end(state2[stage]), 0.0f);
+    }
+    std::fill(std::begin(blockEnergy), std::end(blockEnergy), 0.0f);
+    blockFill = 0;
+    levels.fill(0.0f);
+    baseline = 0.0f;
+    blocksSinceHit = refractoryBlocks;
+}
@@ -0,0 +1,147 @@
+// PercussionNodes.hpp
+#ifndef PERCUSSION_NODES_HPP
+#define PERCUSSION_NODES_HPP
+
+#include "FeatureGraph.hpp"
+#include "FeatureSnapshot.hpp"
+#include "SlidingMedian.hpp"
+#include <array>
+#include <memory>
+#include <vector>
+
+// Drum-oriented analysis nodes:
+//   hpss         [harmonic magnitudes, percussive magnitudes], frameSize/2 bins each
+//   hpss_energy  [harmonic level, percussive level] in frame RMS units
+//   drums        [kick, snare, hihat, hit delay]; a hit sets its type's velocity (0-1)
+//                on the hop it is detected, hit delay is how long ago its transient was
+//   crossover    [BAND_COUNT band levels, bass hit velocity, bass hit delay] from a
+//                time-domain filter bank; independent of the FFT frame size
+
+// Harmonic/percussive separation by median filtering (Fitzgerald). Sustained
+// tones are smooth along time within a bin, hits are smooth along frequency
+// within a frame; a per-bin median over the last HARMONIC_SECONDS and a
+// median across PERCUSSIVE_HZ of neighbouring bins estimate the two, and
+// soft (Wiener) masks split every magnitude between them. The time median is
+// causal, so harmonic onsets register half a window late.
+class HpssNode : public FeatureNode {
+private:
+    static const float HARMONIC_SECONDS;
+    static const float PERCUSSIVE_HZ;
+
+    std::vector<SlidingMedian> harmonicMedians;   // One per bin, across frames
+    std::unique_ptr<SlidingMedian> percussiveMedian;  // Across bins, reused every frame
+
+public:
+    const char* getName() const override { return "hpss"; }
+    std::vector<std::string> getInputs() const override { return { "magnitude" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+};
+
+// Splits the frame RMS between the harmonic and percussive parts by their
+// share of the spectral energy, so harmonic^2 + percussive^2 = rms^2 and both
+// are on the same scale as the volume
+class HpssEnergyNode : public FeatureNode {
+public:
+    const char* getName() const override { return "hpss_energy"; }
+    std::vector<std::string> getInputs() const override { return { "hpss", "rms" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+};
+
+// Typed drum hits from the percussive spectrum. The low, mid and high bands
+// each run an onset detector (rise of the log band level above a running
+// mean + k * deviation); when any band fires, the hit is described by the low
+// and high bands' share of the energy and the spectral centroid, and the
+// nearest drum prototype wins. The decision is made on the detecting hop, so
+// hits are reported about half a frame after the transient.
+class DrumNode : public FeatureNode {
+public:
+    static const size_t BAND_COUNT = 3;
+    static const size_t DRUM_COUNT = 3;      // Kick, snare, hi-hat
+    static const size_t DESCRIPTOR_COUNT = 3;
+
+private:
+    static const float BAND_EDGES[BAND_COUNT + 1];
+    static const float HISTORY_SECONDS;
+    static const float REFRACTORY_SECONDS;
+    static const float SENSITIVITY;
+    static const float MIN_RISE;
+    static const float FULL_VELOCITY_RISE;
+    static const float PROTOTYPES[DRUM_COUNT][DESCRIPTOR_COUNT];   // Low share, high share, centroid
+
+    std::array<size_t, BAND_COUNT + 1> bandBins{};
+    std::vector<float> binOctaves;           // Position of each bin between the outer band edges, 0-1
+    std::array<float, BAND_COUNT> previousLevel{};
+    std::vector<float> history;              // One ring of level rises per band, back to back
+    size_t historyPos = 0;
+    size_t historyFilled = 0;
+    size_t hopsSinceHit = 0;
+    size_t refractoryHops = 1;
+    float hitDelay = 0.0f;
+
+public:
+    const char* getName() const override { return "drums"; }
+    std::vector<std::string> getInputs() const override { return { "hpss" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+};
+
+// Linkwitz-Riley crossover bank run on every sample of the newest hop, for
+// kick response that does not wait for an FFT frame. Each band is an LR4
+// band-pass (two Butterworth low-pass and two high-pass biquads), and the
+// bands run side by side: lane b of each SIMD register is band b, so one
+// pass of four biquad stages filters all bands. Band levels are taken every
+// BLOCK_SIZE samples, and a bass level jump over its recent baseline is a
+// hit, known within one block (1.3 ms at 48 kHz) of the end of the hop it
+// falls in.
+class CrossoverNode : public FeatureNode {
+public:
+    static const size_t BAND_COUNT = CROSSOVER_BAND_COUNT;   // One SSE register of bands
+    static const size_t STAGE_COUNT = 4;
+    static const size_t BLOCK_SIZE = 64;
+
+private:
+    static const float CROSSOVER_HZ[BAND_COUNT - 1];
+    static const float BASELINE_ATTACK_SECONDS;
+    static const float BASELINE_RELEASE_SECONDS;
+    static const float REFRACTORY_SECONDS;
+    static const float HIT_RATIO;             // Block energy over baseline for a hit
+    static const float MIN_HIT_LEVEL;         // Band RMS a hit must reach
+    static const float FULL_VELOCITY_DB;
+
+    // Transposed direct form II coefficients and state, stage-major with
+    // BAND_COUNT lanes each
+    alignas(16) float b0[STAGE_COUNT][BAND_COUNT] = {};
+    alignas(16) float b1[STAGE_COUNT][BAND_COUNT] = {};
+    alignas(16) float b2[STAGE_COUNT][BAND_COUNT] = {};
+    alignas(16) float a1[STAGE_COUNT][BAND_COUNT] = {};
+    alignas(16) float a2[STAGE_COUNT][BAND_COUNT] = {};
+    alignas(16) float state1[STAGE_COUNT][BAND_COUNT] = {};
+    alignas(16) float state2[STAGE_COUNT][BAND_COUNT] = {};
+    alignas(16) float blockEnergy[BAND_COUNT] = {};   // Running sum of the current block
+    size_t blockFill = 0;
+
+    std::array<float, BAND_COUNT> levels{};
+    size_t frameSize = 0;
+    size_t hopSize = 0;
+    float sampleRate = 0.0f;
+    float attackAlpha = 0.0f;
+    float releaseAlpha = 0.0f;
+    float baseline = 0.0f;                    // Bass block energy; quick to rise so one kick fires once
+    size_t refractoryBlocks = 1;
+    size_t blocksSinceHit = 0;
+
+    // Runs count samples through every band, adding to blockEnergy
+    void filter(const std::int16_t* samples, size_t count);
+
+public:
+    const char* getName() const override { return "crossover"; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+};
+
+#endif // PERCUSSION_NODES_HPP
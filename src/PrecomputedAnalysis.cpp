@@ -0,0 +1,38 @@
+// PrecomputedAnalysis.cpp
+#include "PrecomputedAnalysis.hpp"
+
+PrecomputedAnalysis::PrecomputedAnalysis()
+    : openTrack(NO_TRACK)
+    , failedTrack(NO_TRACK)
+{
+}
+
+bool PrecomputedAnalysis::open(const std::string& indexPath, std::string& error) {
+    return index.open(indexPath, error);
+}
+
+bool PrecomputedAnalysis::resolve(const FeatureSnapshot& live, FeatureSnapshot& out) {
+    if (live.matchedTrack < 1.0f) {
+        return false;
+    }
+    size_t track = static_cast<size_t>(live.matchedTrack) - 1;
+    if (track >= index.getTrackCount() || track == failedTrack) {
+        return false;
+    }
+
+    if (track != openTrack) {
+        openTrack = NO_TRACK;
+        if (!timeline.open(index.getTimelinePath(track), error)) {
+            failedTrack = track;
+            return false;
+        }
+        openTrack = track;
+    }
+
+    timeline.readSnapshot(timeline.findRow(live.trackPosition), out);
+    out.time = live.time;
+    out.matchedTrack = live.matchedTrack;
+    out.trackPosition = live.trackPosition;
+    out.matchVotes = live.matchVotes;
+    return true;
+}
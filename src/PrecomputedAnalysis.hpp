@@ -0,0 +1,38 @@
+// PrecomputedAnalysis.hpp
+#ifndef PRECOMPUTED_ANALYSIS_HPP
+#define PRECOMPUTED_ANALYSIS_HPP
+
+#include "FeatureSnapshot.hpp"
+#include "FeatureTimeline.hpp"
+#include "FingerprintIndex.hpp"
+#include <cstddef>
+#include <string>
+
+// Swaps live features for the offline analysis of a recognised track. When
+// the live snapshot reports a match, the track's feature timeline is mapped
+// (once per track change) and the row at the matched position is returned.
+class PrecomputedAnalysis {
+private:
+    static const size_t NO_TRACK = static_cast<size_t>(-1);
+
+    FingerprintIndex index;
+    FeatureTimeline timeline;
+    size_t openTrack;
+    size_t failedTrack;      // Not retried every frame
+    std::string error;
+
+public:
+    PrecomputedAnalysis();
+
+    bool open(const std::string& indexPath, std::string& error);
+
+    // Fills out from the recognised track's timeline and returns true, or
+    // returns false if live has no usable match. Match fields and the
+    // timestamp are taken from live.
+    bool resolve(const FeatureSnapshot& live, FeatureSnapshot& out);
+
+    // Why the last recognised track could not be used, if it could not
+    const std::string& getError() const { return error; }
+};
+
+#endif // PRECOMPUTED_ANALYSIS_HPP
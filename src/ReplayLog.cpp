@@ -0,0 +1,229 @@
+// ReplayLog.cpp
+#include "ReplayLog.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <sstream>
+
+namespace {
+    const char REPLAY_MAGIC[4] = { 'I', 'M', 'L', 'R' };
+    const std::uint32_t REPLAY_VERSION = 1;
+
+    void writeU32(std::ofstream& out, std::uint32_t value) {
+        unsigned char bytes[4] = {
+            static_cast<unsigned char>(value), static_cast<unsigned char>(value >> 8),
+            static_cast<unsigned char>(value >> 16), static_cast<unsigned char>(value >> 24)
+        };
+        out.write(reinterpret_cast<const char*>(bytes), 4);
+    }
+
+    // Bounds-checked little-endian cursor over a loaded file
+    struct Cursor {
+        const std::vector<unsigned char>& data;
+        size_t pos;
+
+        bool has(size_t bytes) const { return pos + bytes <= data.size(); }
+
+        std::uint32_t u32() {
+            const unsigned char* p = data.data() + pos;
+            pos += 4;
+            return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+        }
+    };
+}
+
+ReplayLogWriter::ReplayLogWriter()
+    : dmxChannels(0)
+    , hopIndex(0)
+{
+}
+
+bool ReplayLogWriter::open(const std::string& path, unsigned int sampleRate, unsigned int hopSize, size_t dmxChannels) {
+    out.open(path, std::ios::binary);
+    if (!out) {
+        return false;
+    }
+
+    this->dmxChannels = dmxChannels;
+    hopIndex = 0;
+
+    std::vector<std::string> names = expandedFeatureNames();
+    record.resize(names.size());
+
+    out.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    writeU32(out, REPLAY_VERSION);
+    writeU32(out, sampleRate);
+    writeU32(out, hopSize);
+    writeU32(out, static_cast<std::uint32_t>(names.size()));
+    writeU32(out, static_cast<std::uint32_t>(dmxChannels));
+    for (const std::string& name : names) {
+        unsigned char length = static_cast<unsigned char>(std::min<size_t>(name.size(), 255));
+        out.put(static_cast<char>(length));
+        out.write(name.data(), length);
+    }
+    return static_cast<bool>(out);
+}
+
+void ReplayLogWriter::write(const FeatureSnapshot& snapshot, const DmxFrame& frame) {
+    size_t column = 0;
+    for (const FeatureField& field : FEATURE_FIELDS) {
+        const float* values = featureData(snapshot, field);
+        for (size_t i = 0; i < field.count; ++i) {
+            record[column++] = values[i];
+        }
+    }
+
+    writeU32(out, hopIndex++);
+    out.write(reinterpret_cast<const char*>(record.data()), record.size() * sizeof(float));
+    out.write(reinterpret_cast<const char*>(frame.channels.data()), dmxChannels);
+}
+
+void ReplayLogWriter::close() {
+    out.close();
+}
+
+ReplayLog::ReplayLog()
+    : sampleRate(0)
+    , hopSize(0)
+    , dmxChannels(0)
+{
+}
+
+bool ReplayLog::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "Could not open " + path;
+        return false;
+    }
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Cursor cursor{ data, 0 };
+    if (!cursor.has(24) || std::memcmp(data.data(), REPLAY_MAGIC, 4) != 0) {
+        error = path + " is not a replay log";
+        return false;
+    }
+    cursor.pos = 4;
+    if (cursor.u32() != REPLAY_VERSION) {
+        error = path + " has an unsupported replay log version";
+        return false;
+    }
+    sampleRate = cursor.u32();
+    hopSize = cursor.u32();
+    size_t featureCount = cursor.u32();
+    dmxChannels = cursor.u32();
+
+    featureNames.clear();
+    for (size_t i = 0; i < featureCount; ++i) {
+        if (!cursor.has(1)) {
+            error = path + " is truncated";
+            return false;
+        }
+        size_t length = data[cursor.pos++];
+        if (!cursor.has(length)) {
+            error = path + " is truncated";
+            return false;
+        }
+        featureNames.emplace_back(reinterpret_cast<const char*>(data.data() + cursor.pos), length);
+        cursor.pos += length;
+    }
+
+    size_t recordSize = 4 + featureCount * sizeof(float) + dmxChannels;
+    size_t hopCount = (data.size() - cursor.pos) / recordSize;
+    hopIndices.resize(hopCount);
+    features.resize(hopCount * featureCount);
+    dmx.resize(hopCount * dmxChannels);
+
+    for (size_t hop = 0; hop < hopCount; ++hop) {
+        hopIndices[hop] = cursor.u32();
+        std::memcpy(features.data() + hop * featureCount, data.data() + cursor.pos, featureCount * sizeof(float));
+        cursor.pos += featureCount * sizeof(float);
+        std::memcpy(dmx.data() + hop * dmxChannels, data.data() + cursor.pos, dmxChannels);
+        cursor.pos += dmxChannels;
+    }
+
+    return true;
+}
+
+ReplayComparison compareReplayLogs(const ReplayLog& golden, const ReplayLog& actual, const ReplayTolerance& tolerance) {
+    ReplayComparison result;
+    std::ostringstream report;
+
+    if (golden.getHopCount() != actual.getHopCount()) {
+        report << "Hop count differs: golden " << golden.getHopCount() << ", actual " << actual.getHopCount() << "\n";
+        result.matches = false;
+    }
+    if (golden.getHopSize() != actual.getHopSize() || golden.getSampleRate() != actual.getSampleRate()) {
+        report << "Timing differs: golden " << golden.getHopSize() << " @ " << golden.getSampleRate()
+               << " Hz, actual " << actual.getHopSize() << " @ " << actual.getSampleRate() << " Hz\n";
+        result.matches = false;
+    }
+
+    size_t hops = std::min(golden.getHopCount(), actual.getHopCount());
+    const std::vector<std::string>& goldenNames = golden.getFeatureNames();
+    const std::vector<std::string>& actualNames = actual.getFeatureNames();
+
+    for (size_t g = 0; g < goldenNames.size(); ++g) {
+        auto found = std::find(actualNames.begin(), actualNames.end(), goldenNames[g]);
+        if (found == actualNames.end()) {
+            report << "Feature '" << goldenNames[g] << "' missing from actual log\n";
+            result.matches = false;
+            continue;
+        }
+        size_t a = static_cast<size_t>(found - actualNames.begin());
+
+        float maxDiff = 0.0f;
+        size_t failures = 0;
+        size_t firstFailure = 0;
+        for (size_t hop = 0; hop < hops; ++hop) {
+            float diff = std::fabs(golden.getFeature(hop, g) - actual.getFeature(hop, a));
+            if (std::isnan(diff) || diff > tolerance.feature) {
+                if (failures++ == 0) {
+                    firstFailure = hop;
+                }
+            }
+            maxDiff = std::max(maxDiff, diff);
+        }
+
+        report << "  " << goldenNames[g] << ": max diff " << maxDiff;
+        if (failures > 0) {
+            report << "  FAIL (" << failures << " hops, first at hop " << firstFailure << ")";
+            result.matches = false;
+        }
+        report << "\n";
+    }
+
+    for (const std::string& name : actualNames) {
+        if (std::find(goldenNames.begin(), goldenNames.end(), name) == goldenNames.end()) {
+            report << "  " << name << ": new feature, not in golden log\n";
+        }
+    }
+
+    size_t channels = std::min(golden.getDmxChannels(), actual.getDmxChannels());
+    if (golden.getDmxChannels() != actual.getDmxChannels()) {
+        report << "DMX patch differs: golden " << golden.getDmxChannels() << " channels, actual "
+               << actual.getDmxChannels() << "\n";
+        result.matches = false;
+    }
+
+    int maxDmxDiff = 0;
+    size_t dmxFailures = 0;
+    for (size_t hop = 0; hop < hops; ++hop) {
+        for (size_t c = 0; c < channels; ++c) {
+            int diff = std::abs(static_cast<int>(golden.getDmx(hop, c)) - static_cast<int>(actual.getDmx(hop, c)));
+            maxDmxDiff = std::max(maxDmxDiff, diff);
+            if (diff > tolerance.dmx) {
+                ++dmxFailures;
+            }
+        }
+    }
+    report << "  dmx: max diff " << maxDmxDiff;
+    if (dmxFailures > 0) {
+        report << "  FAIL (" << dmxFailures << " channel values)";
+        result.matches = false;
+    }
+    report << "\n";
+
+    result.report = report.str();
+    return result;
+}
@@ -0,0 +1,77 @@
+// ReplayLog.hpp
+#ifndef REPLAY_LOG_HPP
+#define REPLAY_LOG_HPP
+
+#include "FeatureSnapshot.hpp"
+#include "LightingEngine.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Compact binary record of a replay: every feature snapshot and DMX frame the
+// pipeline produced, one record per hop.
+//
+// Layout (little-endian):
+//   "IMLR", u32 version, u32 sampleRate, u32 hopSize, u32 featureCount, u32 dmxChannels
+//   featureCount x (u8 length, name bytes)
+//   per hop: u32 hopIndex, f32 features[featureCount], u8 dmx[dmxChannels]
+//
+// Feature names are stored so logs from builds with different feature sets
+// can still be compared column by column.
+class ReplayLogWriter {
+private:
+    std::ofstream out;
+    size_t dmxChannels;
+    std::uint32_t hopIndex;
+    std::vector<float> record;
+
+public:
+    ReplayLogWriter();
+
+    bool open(const std::string& path, unsigned int sampleRate, unsigned int hopSize, size_t dmxChannels);
+    void write(const FeatureSnapshot& snapshot, const DmxFrame& frame);
+    void close();
+};
+
+class ReplayLog {
+private:
+    unsigned int sampleRate;
+    unsigned int hopSize;
+    size_t dmxChannels;
+    std::vector<std::string> featureNames;
+    std::vector<std::uint32_t> hopIndices;
+    std::vector<float> features;        // hopCount x featureCount
+    std::vector<std::uint8_t> dmx;      // hopCount x dmxChannels
+    std::string error;
+
+public:
+    ReplayLog();
+
+    bool load(const std::string& path);
+
+    size_t getHopCount() const { return hopIndices.size(); }
+    unsigned int getSampleRate() const { return sampleRate; }
+    unsigned int getHopSize() const { return hopSize; }
+    size_t getDmxChannels() const { return dmxChannels; }
+    const std::vector<std::string>& getFeatureNames() const { return featureNames; }
+    float getFeature(size_t hop, size_t feature) const { return features[hop * featureNames.size() + feature]; }
+    std::uint8_t getDmx(size_t hop, size_t channel) const { return dmx[hop * dmxChannels + channel]; }
+    const std::string& getError() const { return error; }
+};
+
+struct ReplayTolerance {
+    float feature = 1e-4f;   // Absolute tolerance on every feature value
+    int dmx = 1;             // Allowed difference in DMX levels
+};
+
+struct ReplayComparison {
+    bool matches = true;
+    std::string report;
+};
+
+// Compares a fresh replay against a golden log, column by column.
+// Features present only in the new log are reported but do not fail the comparison.
+ReplayComparison compareReplayLogs(const ReplayLog& golden, const ReplayLog& actual, const ReplayTolerance& tolerance);
+
+#endif // REPLAY_LOG_HPP
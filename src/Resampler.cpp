@@ -0,0 +1,171 @@
+// Resampler.cpp
+#define _USE_MATH_DEFINES
+
+#include "Resampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define RESAMPLER_USE_SSE 1
+#endif
+
+namespace {
+    // Zeroth-order modified Bessel function, for the Kaiser window
+    double besselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 32; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    float dotProduct(const float* a, const float* b, size_t count) {
+#ifdef RESAMPLER_USE_SSE
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        __m128 acc = _mm_add_ps(acc0, acc1);
+        __m128 high = _mm_movehl_ps(acc, acc);
+        acc = _mm_add_ps(acc, high);
+        acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+        float sum = _mm_cvtss_f32(acc);
+#else
+        float sum = 0.0f;
+        size_t i = 0;
+#endif
+        for (; i < count; ++i) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+}
+
+Resampler::Resampler(unsigned int inputRate, unsigned int outputRate, size_t tapsPerPhase)
+    : inputRate(inputRate)
+    , outputRate(outputRate)
+    , tapsPerPhase(tapsPerPhase)
+    , historyFill(0)
+    , inputIndex(0)
+    , phase(0)
+{
+    if (!canConvert(inputRate, outputRate)) {
+        throw std::invalid_argument("Cannot resample " + std::to_string(inputRate) + " Hz to "
+                                    + std::to_string(outputRate) + " Hz: the ratio is not simple enough");
+    }
+    unsigned int divisor = std::gcd(inputRate, outputRate);
+    upFactor = outputRate / divisor;
+    downFactor = inputRate / divisor;
+
+    if (!isPassthrough()) {
+        designFilter();
+        history.resize(tapsPerPhase - 1 + BLOCK_SIZE);
+    }
+    reset();
+}
+
+void Resampler::designFilter() {
+    // Low-pass at 90% of the lower Nyquist frequency, expressed at the
+    // upsampled rate L * inputRate
+    const size_t length = upFactor * tapsPerPhase;
+    const double cutoff = 0.45 / std::max(upFactor, downFactor);
+    const double beta = 8.0;
+    const double centre = (length - 1) / 2.0;
+
+    std::vector<double> prototype(length);
+    for (size_t n = 0; n < length; ++n) {
+        double x = n - centre;
+        double sinc = (x == 0.0) ? 2.0 * cutoff : std::sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+        double ratio = x / centre;
+        double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / besselI0(beta);
+        // Gain of L compensates for the zeros implied by upsampling
+        prototype[n] = sinc * window * upFactor;
+    }
+
+    coefficients.resize(length);
+    for (size_t p = 0; p < upFactor; ++p) {
+        for (size_t k = 0; k < tapsPerPhase; ++k) {
+            coefficients[p * tapsPerPhase + (tapsPerPhase - 1 - k)] = static_cast<float>(prototype[p + k * upFactor]);
+        }
+    }
+}
+
+void Resampler::reset() {
+    std::fill(history.begin(), history.end(), 0.0f);
+    historyFill = tapsPerPhase - 1;
+    inputIndex = tapsPerPhase - 1;
+    phase = 0;
+}
+
+size_t Resampler::getMaxOutput(size_t inputCount) const {
+    if (isPassthrough()) {
+        return inputCount;
+    }
+    // The phase carried over from earlier input can add one extra output
+    return (inputCount * upFactor) / downFactor + 2;
+}
+
+size_t Resampler::getMaxInput(size_t outputSpace) const {
+    if (isPassthrough()) {
+        return outputSpace;
+    }
+    if (outputSpace <= 2) {
+        return 0;
+    }
+    return ((outputSpace - 2) * downFactor) / upFactor;
+}
+
+size_t Resampler::process(const std::int16_t* input, size_t count, std::int16_t* output, size_t maxOutput) {
+    if (isPassthrough()) {
+        size_t copied = std::min(count, maxOutput);
+        std::copy(input, input + copied, output);
+        return copied;
+    }
+
+    size_t written = 0;
+    while (count > 0) {
+        size_t block = std::min(count, history.size() - historyFill);
+        if (block == 0) {
+            break;  // Output space exhausted with the history still full
+        }
+        for (size_t i = 0; i < block; ++i) {
+            history[historyFill + i] = input[i] / 32768.0f;
+        }
+        historyFill += block;
+        input += block;
+        count -= block;
+
+        written += processBlock(output + written, maxOutput - written);
+
+        // Keep the context the next block's first outputs still need
+        size_t consumed = inputIndex - (tapsPerPhase - 1);
+        std::copy(history.begin() + consumed, history.begin() + historyFill, history.begin());
+        historyFill -= consumed;
+        inputIndex -= consumed;
+    }
+    return written;
+}
+
+size_t Resampler::processBlock(std::int16_t* output, size_t maxOutput) {
+    size_t written = 0;
+    while (inputIndex < historyFill && written < maxOutput) {
+        const float* taps = coefficients.data() + phase * tapsPerPhase;
+        const float* window = history.data() + inputIndex + 1 - tapsPerPhase;
+        float value = dotProduct(taps, window, tapsPerPhase) * 32768.0f;
+        output[written++] = static_cast<std::int16_t>(std::clamp(std::lround(value), -32768L, 32767L));
+
+        phase += downFactor;
+        inputIndex += phase / upFactor;
+        phase %= upFactor;
+    }
+    return written;
+}
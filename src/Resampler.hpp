@@ -0,0 +1,67 @@
+// Resampler.hpp
+#ifndef RESAMPLER_HPP
+#define RESAMPLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+// Streaming rational-ratio sample rate converter (polyphase FIR).
+// The rate ratio is reduced to L/M; a Kaiser-windowed sinc prototype of
+// L * tapsPerPhase coefficients is split into L phases, so each output sample
+// costs one tapsPerPhase-long dot product (SSE on x86). Used as the first
+// pipeline stage to bring any device rate to the analysis rate, including
+// decimating 96 kHz input to a cheaper rate. Equal rates pass straight through.
+class Resampler {
+private:
+    static const size_t BLOCK_SIZE = 1024;  // Input samples converted per internal block
+
+    unsigned int inputRate;
+    unsigned int outputRate;
+    size_t upFactor;      // L
+    size_t downFactor;    // M
+    size_t tapsPerPhase;
+
+    // Phase p occupies [p * tapsPerPhase, (p + 1) * tapsPerPhase), stored
+    // reversed so it lines up with the oldest-to-newest input history
+    std::vector<float> coefficients;
+
+    // Input history: tapsPerPhase - 1 samples of context followed by the current block
+    std::vector<float> history;
+    size_t historyFill;
+    size_t inputIndex;    // Newest input sample under the filter for the next output
+    size_t phase;
+
+    void designFilter();
+    size_t processBlock(std::int16_t* output, size_t maxOutput);
+
+public:
+    // The prototype needs one phase per step of the reduced ratio, so odd
+    // rate pairs (e.g. 44101 to 48000 Hz) would build huge tables
+    static const size_t MAX_UP_FACTOR = 1024;
+
+    static bool canConvert(unsigned int inputRate, unsigned int outputRate) {
+        return inputRate > 0 && outputRate > 0 && outputRate / std::gcd(inputRate, outputRate) <= MAX_UP_FACTOR;
+    }
+
+    // Throws std::invalid_argument unless canConvert(inputRate, outputRate)
+    Resampler(unsigned int inputRate, unsigned int outputRate, size_t tapsPerPhase = 32);
+
+    // Converts count input samples, writing at most maxOutput samples.
+    // All input is consumed as long as maxOutput >= getMaxOutput(count).
+    size_t process(const std::int16_t* input, size_t count, std::int16_t* output, size_t maxOutput);
+
+    // Upper bound on output for count input samples, and on the input that
+    // is guaranteed to fit into outputSpace
+    size_t getMaxOutput(size_t inputCount) const;
+    size_t getMaxInput(size_t outputSpace) const;
+
+    void reset();
+
+    bool isPassthrough() const { return upFactor == 1 && downFactor == 1; }
+    unsigned int getInputRate() const { return inputRate; }
+    unsigned int getOutputRate() const { return outputRate; }
+};
+
+#endif // RESAMPLER_HPP
@@ -0,0 +1,21 @@
+// SampleQueue.cpp
+#include "SampleQueue.hpp"
+
+void SampleQueue::push(const std::int16_t* samples, size_t count) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.insert(pending.end(), samples, samples + count);
+    }
+    ready.notify_one();
+}
+
+void SampleQueue::waitAndDrain(std::vector<std::int16_t>& out, std::chrono::milliseconds timeout) {
+    out.clear();
+    std::unique_lock<std::mutex> lock(mutex);
+    ready.wait_for(lock, timeout, [this]() { return !pending.empty(); });
+    out.swap(pending);
+}
+
+void SampleQueue::notify() {
+    ready.notify_all();
+}
@@ -0,0 +1,31 @@
+// SampleQueue.hpp
+#ifndef SAMPLE_QUEUE_HPP
+#define SAMPLE_QUEUE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Hand-off of interleaved samples from a producer thread (capture callback or
+// file pacer) to the analysis thread. Buffers are swapped rather than copied,
+// so once both sides have grown to the usual chunk size nothing allocates.
+class SampleQueue {
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<std::int16_t> pending;
+
+public:
+    void push(const std::int16_t* samples, size_t count);
+
+    // Waits up to timeout for samples, then moves everything pending into out
+    // (replacing its contents). out is empty if nothing arrived.
+    void waitAndDrain(std::vector<std::int16_t>& out, std::chrono::milliseconds timeout);
+
+    // Wakes any waiting consumer, e.g. on shutdown
+    void notify();
+};
+
+#endif // SAMPLE_QUEUE_HPP
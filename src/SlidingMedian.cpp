@@ -0,0 +1,116 @@
+// SlidingMedian.cpp
+#include "SlidingMedian.hpp"
+#include <algorithm>
+#include <utility>
+
+SlidingMedian::SlidingMedian(size_t size)
+    : size(std::max<size_t>(1, size) | 1)
+    , lowerCount((this->size + 1) / 2)
+    , values(this->size)
+    , lower(lowerCount)
+    , upper(this->size - lowerCount)
+    , position(this->size)
+    , inLower(this->size)
+    , next(0)
+{
+    reset();
+}
+
+void SlidingMedian::reset(float value) {
+    // With every value equal, any assignment to the heaps is valid
+    std::fill(values.begin(), values.end(), value);
+    for (size_t i = 0; i < size; ++i) {
+        bool low = i < lowerCount;
+        size_t slot = low ? i : i - lowerCount;
+        (low ? lower : upper)[slot] = static_cast<std::uint32_t>(i);
+        position[i] = static_cast<std::uint32_t>(slot);
+        inLower[i] = low ? 1 : 0;
+    }
+    next = 0;
+}
+
+void SlidingMedian::swapLower(size_t a, size_t b) {
+    std::swap(lower[a], lower[b]);
+    position[lower[a]] = static_cast<std::uint32_t>(a);
+    position[lower[b]] = static_cast<std::uint32_t>(b);
+}
+
+void SlidingMedian::swapUpper(size_t a, size_t b) {
+    std::swap(upper[a], upper[b]);
+    position[upper[a]] = static_cast<std::uint32_t>(a);
+    position[upper[b]] = static_cast<std::uint32_t>(b);
+}
+
+void SlidingMedian::fixLower(size_t slot) {
+    // Sift up, then down; only one of them moves anything
+    while (slot > 0 && lowerAbove(slot, (slot - 1) / 2)) {
+        swapLower(slot, (slot - 1) / 2);
+        slot = (slot - 1) / 2;
+    }
+    while (true) {
+        size_t largest = slot;
+        size_t left = 2 * slot + 1;
+        size_t right = left + 1;
+        if (left < lower.size() && lowerAbove(left, largest)) {
+            largest = left;
+        }
+        if (right < lower.size() && lowerAbove(right, largest)) {
+            largest = right;
+        }
+        if (largest == slot) {
+            return;
+        }
+        swapLower(slot, largest);
+        slot = largest;
+    }
+}
+
+void SlidingMedian::fixUpper(size_t slot) {
+    while (slot > 0 && upperBelow(slot, (slot - 1) / 2)) {
+        swapUpper(slot, (slot - 1) / 2);
+        slot = (slot - 1) / 2;
+    }
+    while (true) {
+        size_t smallest = slot;
+        size_t left = 2 * slot + 1;
+        size_t right = left + 1;
+        if (left < upper.size() && upperBelow(left, smallest)) {
+            smallest = left;
+        }
+        if (right < upper.size() && upperBelow(right, smallest)) {
+            smallest = right;
+        }
+        if (smallest == slot) {
+            return;
+        }
+        swapUpper(slot, smallest);
+        slot = smallest;
+    }
+}
+
+float SlidingMedian::push(float value) {
+    size_t index = next;
+    next = (next + 1) % size;
+    values[index] = value;
+    if (inLower[index]) {
+        fixLower(position[index]);
+    }
+    else {
+        fixUpper(position[index]);
+    }
+
+    // Keep every lower value <= every upper value by exchanging the tops
+    if (!upper.empty() && values[lower[0]] > values[upper[0]]) {
+        std::uint32_t low = lower[0];
+        std::uint32_t high = upper[0];
+        lower[0] = high;
+        upper[0] = low;
+        position[high] = 0;
+        position[low] = 0;
+        inLower[high] = 1;
+        inLower[low] = 0;
+        fixLower(0);
+        fixUpper(0);
+    }
+    return values[lower[0]];
+}
@@ -0,0 +1,46 @@
+// SlidingMedian.hpp
+#ifndef SLIDING_MEDIAN_HPP
+#define SLIDING_MEDIAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Median of the last N values, updated in O(log N) per value. The window is
+// split between a max-heap holding the lower half (its top is the median)
+// and a min-heap holding the upper half. Each push overwrites the oldest
+// value in place, restores its heap and then swaps the two tops if they are
+// out of order; the heap sizes never change, so nothing is allocated after
+// construction. N is rounded up to an odd number.
+class SlidingMedian {
+private:
+    size_t size;
+    size_t lowerCount;                   // (size + 1) / 2; the rest are in upper
+    std::vector<float> values;           // Ring buffer, oldest at next
+    std::vector<std::uint32_t> lower;    // Max-heap of value indices
+    std::vector<std::uint32_t> upper;    // Min-heap of value indices
+    std::vector<std::uint32_t> position; // Per value: heap slot
+    std::vector<std::uint8_t> inLower;   // Per value: which heap
+    size_t next;
+
+    bool lowerAbove(size_t a, size_t b) const { return values[lower[a]] > values[lower[b]]; }
+    bool upperBelow(size_t a, size_t b) const { return values[upper[a]] < values[upper[b]]; }
+    void swapLower(size_t a, size_t b);
+    void swapUpper(size_t a, size_t b);
+    void fixLower(size_t slot);
+    void fixUpper(size_t slot);
+
+public:
+    explicit SlidingMedian(size_t size);
+
+    // Fills the whole window with value
+    void reset(float value = 0.0f);
+
+    // Replaces the oldest value and returns the new median
+    float push(float value);
+
+    float getMedian() const { return values[lower[0]]; }
+    size_t getSize() const { return size; }
+};
+
+#endif // SLIDING_MEDIAN_HPP
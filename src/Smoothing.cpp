@@ -0,0 +1,142 @@
+// Smoothing.cpp
+#define _USE_MATH_DEFINES
+
+#include "Smoothing.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define SMOOTHING_USE_SSE 1
+#endif
+
+const float SmoothingBank::DERIVATIVE_CUTOFF = 1.0f;
+const float SmoothingBank::FLUSH_LEVEL = 1e-6f;   // Long before denormals, which are slow to compute with
+
+namespace {
+    // Exact one-pole step for a time constant; 0 seconds follows immediately
+    float envelopeAlpha(double timeConstant, double hopSeconds) {
+        return timeConstant > 0.0 ? static_cast<float>(1.0 - std::exp(-hopSeconds / timeConstant)) : 1.0f;
+    }
+
+    // One-euro smoothing factor for a cutoff, from its 2 pi * cutoff * hop step
+    float cutoffAlpha(double step) {
+        return static_cast<float>(step / (step + 1.0));
+    }
+}
+
+SmoothingBank::SmoothingBank(size_t laneCount, double hopSeconds)
+    : laneCount(laneCount)
+    , hopSeconds(hopSeconds)
+{
+    // Padding lanes stay type None with harmless constants
+    size_t padded = (laneCount + LANE_GROUP - 1) / LANE_GROUP * LANE_GROUP;
+    for (std::vector<float>* lanes : { &attackAlpha, &releaseAlpha, &derivativeAlpha, &minCutoffStep, &betaStep,
+                                       &varianceStep, &measurementNoise, &noneWeight, &envelopeWeight,
+                                       &oneEuroWeight, &kalmanWeight, &values, &previousInputs, &speeds,
+                                       &variances, &inputs }) {
+        lanes->assign(padded, 0.0f);
+    }
+    std::fill(noneWeight.begin(), noneWeight.end(), 1.0f);
+    std::fill(measurementNoise.begin(), measurementNoise.end(), 1.0f);
+    for (size_t lane = 0; lane < laneCount; ++lane) {
+        configure(lane, SmoothingSettings());
+    }
+    reset();
+}
+
+void SmoothingBank::configure(size_t lane, const SmoothingSettings& settings) {
+    attackAlpha[lane] = envelopeAlpha(settings.attack, hopSeconds);
+    releaseAlpha[lane] = envelopeAlpha(settings.release, hopSeconds);
+    derivativeAlpha[lane] = cutoffAlpha(2.0 * M_PI * DERIVATIVE_CUTOFF * hopSeconds);
+    minCutoffStep[lane] = static_cast<float>(2.0 * M_PI * settings.minCutoff * hopSeconds);
+    betaStep[lane] = static_cast<float>(2.0 * M_PI * settings.beta * hopSeconds);
+    varianceStep[lane] = static_cast<float>(settings.processNoise * hopSeconds);
+    measurementNoise[lane] = std::max(settings.measurementNoise, 1e-9f);
+    noneWeight[lane] = settings.type == SmoothingType::None ? 1.0f : 0.0f;
+    envelopeWeight[lane] = settings.type == SmoothingType::Envelope ? 1.0f : 0.0f;
+    oneEuroWeight[lane] = settings.type == SmoothingType::OneEuro ? 1.0f : 0.0f;
+    kalmanWeight[lane] = settings.type == SmoothingType::Kalman ? 1.0f : 0.0f;
+}
+
+void SmoothingBank::reset() {
+    std::fill(values.begin(), values.end(), 0.0f);
+    std::fill(previousInputs.begin(), previousInputs.end(), 0.0f);
+    std::fill(speeds.begin(), speeds.end(), 0.0f);
+    std::fill(inputs.begin(), inputs.end(), 0.0f);
+    // The Kalman filter starts unsure of the value, so it converges quickly
+    std::fill(variances.begin(), variances.end(), 1.0f);
+}
+
+// Per lane, with x the input and y the smoothed value:
+//   envelope  alpha = x > y ? attack : release
+//   one-euro  speed += dAlpha * ((x - xPrev) / hop - speed), step = 2 pi (minCutoff + beta |speed|) hop,
+//             alpha = step / (step + 1)
+//   Kalman    P += q hop, alpha = P / (P + r), P *= 1 - alpha
+// and y += alpha * (x - y), with the alpha picked by the lane's weights. A
+// value fading out after its input drops to 0 stops at 0 instead of
+// creeping down through the denormals.
+void SmoothingBank::process() {
+    size_t padded = values.size();
+    float invHop = static_cast<float>(1.0 / hopSeconds);
+#ifdef SMOOTHING_USE_SSE
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 invHopV = _mm_set1_ps(invHop);
+    const __m128 flush = _mm_set1_ps(FLUSH_LEVEL);
+    for (size_t i = 0; i < padded; i += LANE_GROUP) {
+        __m128 x = _mm_loadu_ps(inputs.data() + i);
+        __m128 y = _mm_loadu_ps(values.data() + i);
+
+        __m128 rising = _mm_cmpgt_ps(x, y);
+        __m128 envelope = _mm_or_ps(_mm_and_ps(rising, _mm_loadu_ps(attackAlpha.data() + i)),
+                                    _mm_andnot_ps(rising, _mm_loadu_ps(releaseAlpha.data() + i)));
+
+        __m128 speed = _mm_loadu_ps(speeds.data() + i);
+        __m128 rawSpeed = _mm_mul_ps(_mm_sub_ps(x, _mm_loadu_ps(previousInputs.data() + i)), invHopV);
+        speed = _mm_add_ps(speed, _mm_mul_ps(_mm_loadu_ps(derivativeAlpha.data() + i), _mm_sub_ps(rawSpeed, speed)));
+        __m128 step = _mm_add_ps(_mm_loadu_ps(minCutoffStep.data() + i),
+                                 _mm_mul_ps(_mm_loadu_ps(betaStep.data() + i), _mm_and_ps(speed, absMask)));
+        __m128 oneEuro = _mm_div_ps(step, _mm_add_ps(step, one));
+
+        __m128 variance = _mm_add_ps(_mm_loadu_ps(variances.data() + i), _mm_loadu_ps(varianceStep.data() + i));
+        __m128 gain = _mm_div_ps(variance, _mm_add_ps(variance, _mm_loadu_ps(measurementNoise.data() + i)));
+        variance = _mm_mul_ps(variance, _mm_sub_ps(one, gain));
+
+        __m128 alpha = _mm_add_ps(
+            _mm_add_ps(_mm_loadu_ps(noneWeight.data() + i), _mm_mul_ps(_mm_loadu_ps(envelopeWeight.data() + i), envelope)),
+            _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(oneEuroWeight.data() + i), oneEuro),
+                       _mm_mul_ps(_mm_loadu_ps(kalmanWeight.data() + i), gain)));
+        y = _mm_add_ps(y, _mm_mul_ps(alpha, _mm_sub_ps(x, y)));
+        y = _mm_and_ps(y, _mm_cmpge_ps(_mm_and_ps(y, absMask), flush));
+        speed = _mm_and_ps(speed, _mm_cmpge_ps(_mm_and_ps(speed, absMask), flush));
+
+        _mm_storeu_ps(values.data() + i, y);
+        _mm_storeu_ps(previousInputs.data() + i, x);
+        _mm_storeu_ps(speeds.data() + i, speed);
+        _mm_storeu_ps(variances.data() + i, variance);
+    }
+#else
+    for (size_t i = 0; i < padded; ++i) {
+        float x = inputs[i];
+        float y = values[i];
+
+        float envelope = x > y ? attackAlpha[i] : releaseAlpha[i];
+
+        float rawSpeed = (x - previousInputs[i]) * invHop;
+        speeds[i] += derivativeAlpha[i] * (rawSpeed - speeds[i]);
+        float step = minCutoffStep[i] + betaStep[i] * std::fabs(speeds[i]);
+        float oneEuro = step / (step + 1.0f);
+
+        float variance = variances[i] + varianceStep[i];
+        float gain = variance / (variance + measurementNoise[i]);
+        variances[i] = variance * (1.0f - gain);
+
+        float alpha = noneWeight[i] + envelopeWeight[i] * envelope + oneEuroWeight[i] * oneEuro + kalmanWeight[i] * gain;
+        y += alpha * (x - y);
+        values[i] = std::fabs(y) >= FLUSH_LEVEL ? y : 0.0f;
+        speeds[i] = std::fabs(speeds[i]) >= FLUSH_LEVEL ? speeds[i] : 0.0f;
+        previousInputs[i] = x;
+    }
+#endif
+}
@@ -0,0 +1,76 @@
+// Smoothing.hpp
+#ifndef SMOOTHING_HPP
+#define SMOOTHING_HPP
+
+#include <cstddef>
+#include <vector>
+
+enum class SmoothingType {
+    None,
+    Envelope,   // Attack/release follower: separate time constants up and down
+    OneEuro,    // One-euro filter: cutoff rises with speed, so little lag on fast moves and little jitter at rest
+    Kalman      // Scalar Kalman filter of a random walk
+};
+
+// How one feature is smoothed. Times are in seconds of audio, so the result
+// does not depend on the hop size or the analysis rate.
+struct SmoothingSettings {
+    SmoothingType type = SmoothingType::Envelope;
+    float attack = 0.05f;              // Envelope time constants (0 = jump)
+    float release = 0.05f;
+    float minCutoff = 1.0f;            // One-euro cutoff at rest, Hz
+    float beta = 0.5f;                 // One-euro cutoff increase per unit/s of speed
+    float processNoise = 1.0f;         // Kalman variance growth per second
+    float measurementNoise = 0.01f;    // Kalman measurement variance
+};
+
+// Smooths a fixed set of features ("lanes") once per hop. The state is kept
+// as structure-of-arrays and every filter type is written as the same update,
+// value += alpha * (input - value), with a per-lane alpha, so four lanes are
+// processed per SSE instruction whatever filter each one uses.
+class SmoothingBank {
+private:
+    static const size_t LANE_GROUP = 4;
+    static const float DERIVATIVE_CUTOFF;   // One-euro speed estimate cutoff, Hz
+    static const float FLUSH_LEVEL;         // Values and speeds decaying below this become 0
+
+    size_t laneCount;
+    double hopSeconds;
+
+    // Per-lane constants, derived from the settings and the hop length. The
+    // weights are 0 or 1 and pick the lane's filter type.
+    std::vector<float> attackAlpha;
+    std::vector<float> releaseAlpha;
+    std::vector<float> derivativeAlpha;
+    std::vector<float> minCutoffStep;       // 2 pi * minCutoff * hopSeconds
+    std::vector<float> betaStep;            // 2 pi * beta * hopSeconds
+    std::vector<float> varianceStep;        // processNoise * hopSeconds
+    std::vector<float> measurementNoise;
+    std::vector<float> noneWeight;
+    std::vector<float> envelopeWeight;
+    std::vector<float> oneEuroWeight;
+    std::vector<float> kalmanWeight;
+
+    // State
+    std::vector<float> values;
+    std::vector<float> previousInputs;
+    std::vector<float> speeds;
+    std::vector<float> variances;
+    std::vector<float> inputs;
+
+public:
+    // Lanes start as envelope followers with the default settings
+    SmoothingBank(size_t laneCount, double hopSeconds);
+
+    void configure(size_t lane, const SmoothingSettings& settings);
+    void reset();
+
+    // Writable input for one lane; fill every lane, then call process()
+    float& input(size_t lane) { return inputs[lane]; }
+    // Runs one hop over all lanes
+    void process();
+    float getValue(size_t lane) const { return values[lane]; }
+    size_t getLaneCount() const { return laneCount; }
+};
+
+#endif // SMOOTHING_HPP
@@ -0,0 +1,131 @@
+// StreamingQuantile.cpp
+#include "StreamingQuantile.hpp"
+#include <algorithm>
+#include <cmath>
+
+const double QuantileRange::LOW_QUANTILE = 0.05;
+const double QuantileRange::HIGH_QUANTILE = 0.95;
+
+P2Quantile::P2Quantile(double quantile)
+    : quantile(quantile)
+    , increments{ 0.0, quantile / 2.0, quantile, (1.0 + quantile) / 2.0, 1.0 }
+{
+    reset();
+}
+
+void P2Quantile::reset() {
+    count = 0;
+    for (size_t i = 0; i < 5; ++i) {
+        positions[i] = static_cast<double>(i + 1);
+        desired[i] = 1.0 + 4.0 * increments[i];
+    }
+}
+
+double P2Quantile::parabolic(size_t i, double direction) const {
+    double below = positions[i] - positions[i - 1];
+    double above = positions[i + 1] - positions[i];
+    double span = positions[i + 1] - positions[i - 1];
+    return heights[i] + direction / span
+         * ((below + direction) * (heights[i + 1] - heights[i]) / above
+          + (above - direction) * (heights[i] - heights[i - 1]) / below);
+}
+
+double P2Quantile::linear(size_t i, double direction) const {
+    size_t j = direction > 0.0 ? i + 1 : i - 1;
+    return heights[i] + direction * (heights[j] - heights[i]) / (positions[j] - positions[i]);
+}
+
+void P2Quantile::add(double value) {
+    // The first five values are kept sorted as the initial markers
+    if (count < 5) {
+        heights[count] = value;
+        ++count;
+        std::sort(heights.begin(), heights.begin() + count);
+        return;
+    }
+
+    size_t cell;
+    if (value < heights[0]) {
+        heights[0] = value;
+        cell = 0;
+    }
+    else if (value >= heights[4]) {
+        heights[4] = std::max(heights[4], value);
+        cell = 3;
+    }
+    else {
+        cell = 0;
+        while (value >= heights[cell + 1]) {
+            ++cell;
+        }
+    }
+    for (size_t i = cell + 1; i < 5; ++i) {
+        positions[i] += 1.0;
+    }
+    for (size_t i = 0; i < 5; ++i) {
+        desired[i] += increments[i];
+    }
+    ++count;
+
+    // Move the middle markers at most one rank towards where they should be
+    for (size_t i = 1; i < 4; ++i) {
+        double offset = desired[i] - positions[i];
+        if ((offset >= 1.0 && positions[i + 1] - positions[i] > 1.0)
+            || (offset <= -1.0 && positions[i - 1] - positions[i] < -1.0)) {
+            double direction = offset > 0.0 ? 1.0 : -1.0;
+            double height = parabolic(i, direction);
+            if (height <= heights[i - 1] || height >= heights[i + 1]) {
+                height = linear(i, direction);
+            }
+            heights[i] = height;
+            positions[i] += direction;
+        }
+    }
+}
+
+double P2Quantile::get() const {
+    if (count == 0) {
+        return 0.0;
+    }
+    if (count < 5) {
+        size_t rank = static_cast<size_t>(std::lround(quantile * (count - 1)));
+        return heights[rank];
+    }
+    return heights[2];
+}
+
+QuantileRange::QuantileRange(size_t windowHops, double minSpan)
+    : low{ P2Quantile(LOW_QUANTILE), P2Quantile(LOW_QUANTILE) }
+    , high{ P2Quantile(HIGH_QUANTILE), P2Quantile(HIGH_QUANTILE) }
+    , windowHops(std::max<size_t>(1, windowHops))
+    , minSpan(minSpan)
+{
+}
+
+void QuantileRange::reset() {
+    for (size_t pair = 0; pair < 2; ++pair) {
+        low[pair].reset();
+        high[pair].reset();
+    }
+    hops = 0;
+    older = 0;
+}
+
+void QuantileRange::add(double value) {
+    for (size_t pair = 0; pair < 2; ++pair) {
+        low[pair].add(value);
+        high[pair].add(value);
+    }
+    if (++hops % windowHops == 0) {
+        // The younger pair now covers a full window and takes over
+        low[older].reset();
+        high[older].reset();
+        older = 1 - older;
+    }
+}
+
+float QuantileRange::normalize(double value) const {
+    double bottom = low[older].get();
+    double span = std::max(high[older].get() - bottom, minSpan);
+    return static_cast<float>(std::clamp((value - bottom) / span, 0.0, 1.0));
+}
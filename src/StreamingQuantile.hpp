@@ -0,0 +1,66 @@
+// StreamingQuantile.hpp
+#ifndef STREAMING_QUANTILE_HPP
+#define STREAMING_QUANTILE_HPP
+
+#include <array>
+#include <cstddef>
+
+// One quantile of a stream with the P^2 algorithm (Jain & Chlamtac): five
+// markers track the minimum, the p/2, p and (1+p)/2 quantiles and the
+// maximum, and each value moves them towards their ideal positions with a
+// piecewise-parabolic step. O(1) time and fixed memory per value.
+class P2Quantile {
+private:
+    double quantile;
+    std::array<double, 5> heights{};
+    std::array<double, 5> positions{};       // 1-based marker ranks
+    std::array<double, 5> desired{};
+    std::array<double, 5> increments{};
+    size_t count = 0;
+
+    double parabolic(size_t i, double direction) const;
+    double linear(size_t i, double direction) const;
+
+public:
+    explicit P2Quantile(double quantile = 0.5);
+
+    void add(double value);
+    void reset();
+
+    // Current estimate; exact while fewer than five values have been added
+    double get() const;
+    size_t getCount() const { return count; }
+};
+
+// The recent LOW_QUANTILE..HIGH_QUANTILE range of a feature, for mapping it
+// onto 0-1. P^2 summarises the whole stream, so two sketch pairs run side by
+// side and the older one is restarted every window: the range always covers
+// the last one to two windows. The restarts fall on multiples of windowHops
+// counted from the first value.
+class QuantileRange {
+private:
+    static const double LOW_QUANTILE;
+    static const double HIGH_QUANTILE;
+
+    std::array<P2Quantile, 2> low;
+    std::array<P2Quantile, 2> high;
+    size_t windowHops;
+    size_t hops = 0;
+    double minSpan;
+    size_t older = 0;                        // Sketch pair answering queries
+
+public:
+    // minSpan keeps a near-constant input (e.g. a noise floor) from being
+    // stretched over the whole output range
+    QuantileRange(size_t windowHops, double minSpan);
+
+    void add(double value);
+    void reset();
+
+    // value relative to the range, clamped to 0-1
+    float normalize(double value) const;
+    double getLow() const { return low[older].get(); }
+    double getHigh() const { return high[older].get(); }
+};
+
+#endif // STREAMING_QUANTILE_HPP
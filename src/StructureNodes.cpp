@@ -0,0 +1,300 @@
+// StructureNodes.cpp
+#include "StructureNodes.hpp"
+#include <algorithm>
+#include <cmath>
+
+const float SectionNode::BLOCK_SECONDS = 0.5f;
+const float SectionNode::MIN_SECTION_SECONDS = 8.0f;
+const float SectionNode::MIN_NOVELTY = 0.45f;
+const float SectionNode::DROP_LEVEL_RATIO = 0.8f;
+const float SectionNode::DROP_BASS_GAIN = 0.15f;
+const float SectionNode::BREAKDOWN_LEVEL_RATIO = 0.6f;
+const float SectionNode::BUILD_UP_LEVEL_RATIO = 1.3f;
+const float DropNode::BLOCK_SECONDS = 0.5f;
+const float DropNode::LEVEL_FLOOR_DB = -80.0f;
+const float DropNode::FULL_LEVEL_SLOPE = 0.5f;
+const float DropNode::FULL_SWEEP = 0.1f;
+const float DropNode::FULL_ROLL_RATE = 8.0f;
+const float DropNode::FULL_RATE_SLOPE = 0.5f;
+const float DropNode::EVIDENCE_WEIGHTS[4] = { 0.35f, 0.25f, 0.2f, 0.2f };   // Level, sweep, roll, rate
+const float DropNode::ARM_PROBABILITY = 0.5f;
+const float DropNode::DISARM_PROBABILITY = 0.25f;
+const float DropNode::DEFAULT_BUILD_DB = 12.0f;
+const float DropNode::DROP_JUMP_DB = 3.0f;
+const float DropNode::DROP_SWEEP_FALL = 0.75f;
+const float DropNode::MAX_COUNTDOWN = 30.0f;
+
+size_t SectionNode::prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) {
+    dimensions = inputSizes[0];
+    double hopSeconds = static_cast<double>(context.hopSize) / context.sampleRate;
+    blockHops = std::max<size_t>(1, static_cast<size_t>(std::lround(BLOCK_SECONDS / hopSeconds)));
+    minSectionBlocks = static_cast<size_t>(std::ceil(MIN_SECTION_SECONDS / BLOCK_SECONDS));
+    blockSum.assign(dimensions, 0.0f);
+    blocks.assign(WINDOW_BLOCKS * dimensions, 0.0f);
+    reset();
+    return 3;
+}
+
+void SectionNode::reset() {
+    hopInBlock = 0;
+    std::fill(blockSum.begin(), blockSum.end(), 0.0f);
+    levelSum = 0.0f;
+    std::fill(blocks.begin(), blocks.end(), 0.0f);
+    levels.fill(0.0f);
+    bassShares.fill(0.0f);
+    distances.fill(0.0f);
+    newest = 0;
+    blockCount = 0;
+    novelty = 0.0f;
+    previousNovelty = 0.0f;
+    blocksSinceChange = 0;
+    label = SECTION_OTHER;
+}
+
+double SectionNode::getSettleSeconds() const {
+    // The novelty window, then a minimum section so that the spacing of
+    // section changes lines up with a serial run
+    return WINDOW_BLOCKS * BLOCK_SECONDS + MIN_SECTION_SECONDS;
+}
+
+float SectionNode::computeNovelty() const {
+    // Checkerboard kernel: mean distance across the boundary minus the mean
+    // distance within each side
+    float across = 0.0f;
+    float past = 0.0f;
+    float future = 0.0f;
+    for (size_t i = 0; i < WINDOW_BLOCKS; ++i) {
+        for (size_t j = i + 1; j < WINDOW_BLOCKS; ++j) {
+            float distance = distances[slot(i) * WINDOW_BLOCKS + slot(j)];
+            if (j < PAST_BLOCKS) {
+                past += distance;
+            }
+            else if (i >= PAST_BLOCKS) {
+                future += distance;
+            }
+            else {
+                across += distance;
+            }
+        }
+    }
+    across /= PAST_BLOCKS * FUTURE_BLOCKS;
+    past /= PAST_BLOCKS * (PAST_BLOCKS - 1) / 2;
+    future /= FUTURE_BLOCKS * (FUTURE_BLOCKS - 1) / 2;
+    return across - 0.5f * (past + future);
+}
+
+SectionLabel SectionNode::classify(size_t start) const {
+    float before = 0.0f;
+    float after = 0.0f;
+    float bassBefore = 0.0f;
+    float bassAfter = 0.0f;
+    for (size_t position = 0; position < WINDOW_BLOCKS; ++position) {
+        if (position < start) {
+            before += levels[slot(position)];
+            bassBefore += bassShares[slot(position)];
+        }
+        else {
+            after += levels[slot(position)];
+            bassAfter += bassShares[slot(position)];
+        }
+    }
+    size_t afterCount = WINDOW_BLOCKS - start;
+    before /= start;
+    after /= afterCount;
+    bassBefore /= start;
+    bassAfter /= afterCount;
+
+    if (after <= BREAKDOWN_LEVEL_RATIO * before) {
+        return SECTION_BREAKDOWN;
+    }
+    if (after >= DROP_LEVEL_RATIO * before && bassAfter >= bassBefore + DROP_BASS_GAIN) {
+        return SECTION_DROP;
+    }
+    if (after >= BUILD_UP_LEVEL_RATIO * before
+        || levels[slot(WINDOW_BLOCKS - 1)] >= BUILD_UP_LEVEL_RATIO * levels[slot(start)]) {
+        return SECTION_BUILD_UP;
+    }
+    return SECTION_OTHER;
+}
+
+void SectionNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    std::span<const float> bands = inputs[0];
+    for (size_t i = 0; i < dimensions; ++i) {
+        blockSum[i] += bands[i];
+    }
+    levelSum += inputs[1][0];
+    output[1] = 0.0f;
+
+    if (++hopInBlock == blockHops) {
+        // Close the block into the next ring slot
+        newest = (newest + 1) % WINDOW_BLOCKS;
+        float* block = blocks.data() + newest * dimensions;
+        float bass = 0.0f;
+        float total = 0.0f;
+        for (size_t i = 0; i < dimensions; ++i) {
+            float mean = blockSum[i] / blockHops;
+            block[i] = std::log1p(mean);
+            bass += i < BASS_BANDS ? mean : 0.0f;
+            total += mean;
+        }
+        levels[newest] = levelSum / blockHops;
+        bassShares[newest] = total > 0.0f ? bass / total : 0.0f;
+        std::fill(blockSum.begin(), blockSum.end(), 0.0f);
+        levelSum = 0.0f;
+        hopInBlock = 0;
+
+        // Extend the similarity band by one row: RMS distance to every other block
+        for (size_t other = 0; other < WINDOW_BLOCKS; ++other) {
+            const float* otherBlock = blocks.data() + other * dimensions;
+            float sumSquares = 0.0f;
+            for (size_t i = 0; i < dimensions; ++i) {
+                sumSquares += (block[i] - otherBlock[i]) * (block[i] - otherBlock[i]);
+            }
+            float distance = std::sqrt(sumSquares / dimensions);
+            distances[newest * WINDOW_BLOCKS + other] = distance;
+            distances[other * WINDOW_BLOCKS + newest] = distance;
+        }
+        ++blockCount;
+        ++blocksSinceChange;
+
+        if (blockCount >= WINDOW_BLOCKS) {
+            // The last block's novelty was a peak: its boundary is now one block further back
+            float current = computeNovelty();
+            if (novelty > previousNovelty && novelty >= current && novelty > MIN_NOVELTY
+                && blocksSinceChange > minSectionBlocks) {
+                label = classify(PAST_BLOCKS - 1);
+                blocksSinceChange = FUTURE_BLOCKS + 1;
+                output[1] = 1.0f;
+            }
+            else if (label == SECTION_OTHER && blocksSinceChange >= WINDOW_BLOCKS
+                     && levels[newest] >= BUILD_UP_LEVEL_RATIO * levels[slot(0)]) {
+                // A steady rise inside a section turns it into a build-up
+                label = SECTION_BUILD_UP;
+            }
+            previousNovelty = novelty;
+            novelty = current;
+        }
+    }
+
+    output[0] = novelty;
+    output[2] = static_cast<float>(label);
+}
+
+size_t DropNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    hopSeconds = static_cast<float>(context.hopSize) / context.sampleRate;
+    blockHops = std::max<size_t>(1, static_cast<size_t>(std::lround(BLOCK_SECONDS / hopSeconds)));
+    reset();
+    return 3;
+}
+
+void DropNode::reset() {
+    hopInBlock = 0;
+    rmsSum = 0.0f;
+    octaveSum = 0.0f;
+    onsetCount = 0.0f;
+    levels.fill(0.0f);
+    octaves.fill(0.0f);
+    rates.fill(0.0f);
+    newest = 0;
+    blockCount = 0;
+    armed = false;
+    buildStartLevel = 0.0f;
+    hasTarget = false;
+    targetLevel = 0.0f;
+    probability = 0.0f;
+    countdown = 0.0f;
+}
+
+double DropNode::getSettleSeconds() const {
+    // The trend window; the target level of the last drop is carried further
+    return TREND_BLOCKS * BLOCK_SECONDS;
+}
+
+float DropNode::slope(const std::array<float, TREND_BLOCKS>& values) const {
+    float meanX = 0.5f * (TREND_BLOCKS - 1);
+    float meanY = 0.0f;
+    for (float value : values) {
+        meanY += value;
+    }
+    meanY /= TREND_BLOCKS;
+    float covariance = 0.0f;
+    float variance = 0.0f;
+    for (size_t position = 0; position < TREND_BLOCKS; ++position) {
+        float x = position - meanX;
+        covariance += x * (values[(newest + 1 + position) % TREND_BLOCKS] - meanY);
+        variance += x * x;
+    }
+    return covariance / variance / BLOCK_SECONDS;
+}
+
+void DropNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    rmsSum += inputs[0][0];
+    octaveSum += std::log2(std::max(inputs[1][0], 20.0f));
+    onsetCount += inputs[2][1];
+    output[2] = 0.0f;
+    countdown = std::max(0.0f, countdown - hopSeconds);
+
+    if (++hopInBlock == blockHops) {
+        size_t previous = newest;
+        newest = (newest + 1) % TREND_BLOCKS;
+        float rms = rmsSum / blockHops;
+        levels[newest] = rms > 0.0f ? std::max(LEVEL_FLOOR_DB, 20.0f * std::log10(rms)) : LEVEL_FLOOR_DB;
+        octaves[newest] = octaveSum / blockHops;
+        rates[newest] = onsetCount / BLOCK_SECONDS;
+        rmsSum = 0.0f;
+        octaveSum = 0.0f;
+        onsetCount = 0.0f;
+        hopInBlock = 0;
+        ++blockCount;
+
+        // The drop may straddle two blocks, so compare with the two before
+        size_t earlier = (previous + TREND_BLOCKS - 1) % TREND_BLOCKS;
+        float levelBefore = std::min(levels[previous], levels[earlier]);
+        float octaveBefore = std::max(octaves[previous], octaves[earlier]);
+        if (armed && (levels[newest] >= levelBefore + DROP_JUMP_DB
+                      || octaves[newest] <= octaveBefore - DROP_SWEEP_FALL)) {
+            // The drop: remember how loud the build-up got before it
+            output[2] = 1.0f;
+            hasTarget = true;
+            targetLevel = std::max(levels[previous], levels[earlier]);
+            armed = false;
+            probability = 0.0f;
+            blockCount = 0;                // The build-up's trends must not re-arm straight away
+        }
+        else if (blockCount >= TREND_BLOCKS) {
+            float rollRate = 0.0f;
+            for (size_t i = 0; i < ROLL_BLOCKS; ++i) {
+                rollRate += rates[(newest + TREND_BLOCKS - i) % TREND_BLOCKS];
+            }
+            rollRate /= ROLL_BLOCKS;
+
+            float levelSlope = slope(levels);
+            float evidence[4] = {
+                levelSlope / FULL_LEVEL_SLOPE,
+                slope(octaves) / FULL_SWEEP,
+                rollRate / FULL_ROLL_RATE,
+                slope(rates) / FULL_RATE_SLOPE,
+            };
+            probability = 0.0f;
+            for (size_t i = 0; i < 4; ++i) {
+                probability += EVIDENCE_WEIGHTS[i] * std::clamp(evidence[i], 0.0f, 1.0f);
+            }
+
+            if (!armed && probability >= ARM_PROBABILITY) {
+                armed = true;
+                buildStartLevel = *std::min_element(levels.begin(), levels.end());
+            }
+            else if (armed && probability < DISARM_PROBABILITY) {
+                armed = false;
+            }
+            if (armed) {
+                float target = hasTarget ? targetLevel : buildStartLevel + DEFAULT_BUILD_DB;
+                float remaining = levelSlope > 0.0f ? (target - levels[newest]) / levelSlope : MAX_COUNTDOWN;
+                countdown = std::clamp(remaining, 0.0f, MAX_COUNTDOWN);
+            }
+        }
+    }
+
+    output[0] = probability;
+    output[1] = armed ? countdown : -1.0f;
+}
@@ -0,0 +1,136 @@
+// StructureNodes.hpp
+#ifndef STRUCTURE_NODES_HPP
+#define STRUCTURE_NODES_HPP
+
+#include "FeatureGraph.hpp"
+#include "FeatureSnapshot.hpp"
+#include <array>
+#include <vector>
+
+// Song structure nodes, working on seconds-long blocks of existing features:
+//   sections  [novelty, 1 on the hop a section change is decided, section label]
+//             (SectionLabel: other, build-up, drop, breakdown)
+//   drop      [probability of an imminent drop, seconds until it (-1 when none is
+//             expected), 1 on the hop a predicted drop lands]
+
+// Section boundaries from a self-similarity novelty curve (Foote). Mel bands
+// are averaged over BLOCK_SECONDS blocks; each new block is compared with
+// the last PAST_BLOCKS + FUTURE_BLOCKS - 1 blocks only, so the similarity
+// matrix is a ring buffer of one band around the diagonal rather than n^2.
+// A checkerboard kernel over that band compares the past blocks with the
+// newest future ones: novelty is high when both halves are self-similar but
+// unlike each other. Peaks become section changes FUTURE_BLOCKS + 1 blocks
+// after the boundary, and the new section is labelled from the level and
+// bass change across it.
+class SectionNode : public FeatureNode {
+private:
+    static const size_t PAST_BLOCKS = 16;
+    static const size_t FUTURE_BLOCKS = 4;
+    static const size_t WINDOW_BLOCKS = PAST_BLOCKS + FUTURE_BLOCKS;
+    static const size_t BASS_BANDS = 2;                  // Mel bands counted as bass
+    static const float BLOCK_SECONDS;
+    static const float MIN_SECTION_SECONDS;
+    static const float MIN_NOVELTY;
+    static const float DROP_LEVEL_RATIO;                 // Louder by at least this: drop
+    static const float DROP_BASS_GAIN;                   // ... with this much more bass share
+    static const float BREAKDOWN_LEVEL_RATIO;            // Quieter by at least this: breakdown
+    static const float BUILD_UP_LEVEL_RATIO;             // Rising by this within the new section
+
+    size_t dimensions = 0;
+    size_t blockHops = 1;
+    size_t hopInBlock = 0;
+    std::vector<float> blockSum;                         // Mel bands summed over the current block
+    float levelSum = 0.0f;
+
+    // Ring of the last WINDOW_BLOCKS blocks, newest at slot newest
+    std::vector<float> blocks;                           // Log-compressed mel bands per slot
+    std::array<float, WINDOW_BLOCKS> levels{};
+    std::array<float, WINDOW_BLOCKS> bassShares{};
+    std::array<float, WINDOW_BLOCKS * WINDOW_BLOCKS> distances{};   // Between slots
+    size_t newest = 0;
+    size_t blockCount = 0;
+
+    float novelty = 0.0f;
+    float previousNovelty = 0.0f;
+    size_t blocksSinceChange = 0;
+    size_t minSectionBlocks = 1;
+    SectionLabel label = SECTION_OTHER;
+
+    // Slot of the block at position 0 (oldest) to WINDOW_BLOCKS - 1 (newest)
+    size_t slot(size_t position) const { return (newest + 1 + position) % WINDOW_BLOCKS; }
+    float computeNovelty() const;
+    // Label of a section starting at the given position, from the blocks on either side
+    SectionLabel classify(size_t start) const;
+
+public:
+    const char* getName() const override { return "sections"; }
+    std::vector<std::string> getInputs() const override { return { "mel_bands", "rms" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+    double getSettleSeconds() const override;
+    size_t getBlockFrames() const override { return blockHops; }
+};
+
+// Drop prediction from the trends of features that are already computed.
+// Level (dB), centroid (octaves) and onset rate are averaged into blocks and
+// fitted with a least-squares line over the last TREND_BLOCKS; a rising
+// level, an upward filter sweep, a dense snare roll and an accelerating onset
+// rate each add evidence. Once the evidence passes ARM_PROBABILITY the level
+// trend is extrapolated to the level the previous build-up peaked at (or a
+// default rise on the first one) to give the countdown. A sudden level jump
+// or a collapse of the centroid (the bass arriving) while armed is the drop
+// itself, and the level just before it becomes the next target.
+class DropNode : public FeatureNode {
+private:
+    static const size_t TREND_BLOCKS = 16;
+    static const size_t ROLL_BLOCKS = 4;                 // Blocks the roll density is measured over
+    static const float BLOCK_SECONDS;
+    static const float LEVEL_FLOOR_DB;
+    static const float FULL_LEVEL_SLOPE;                 // dB per second counted as full evidence
+    static const float FULL_SWEEP;                       // Octaves per second
+    static const float FULL_ROLL_RATE;                   // Onsets per second
+    static const float FULL_RATE_SLOPE;                  // Onsets per second, per second
+    static const float EVIDENCE_WEIGHTS[4];
+    static const float ARM_PROBABILITY;
+    static const float DISARM_PROBABILITY;
+    static const float DEFAULT_BUILD_DB;                 // Expected rise of a build-up with no earlier one
+    static const float DROP_JUMP_DB;                     // Level jump between blocks that marks the drop
+    static const float DROP_SWEEP_FALL;                  // ... or centroid fall, in octaves
+    static const float MAX_COUNTDOWN;
+
+    size_t blockHops = 1;
+    size_t hopInBlock = 0;
+    float hopSeconds = 0.0f;
+    float rmsSum = 0.0f;
+    float octaveSum = 0.0f;
+    float onsetCount = 0.0f;
+
+    // Ring of the last TREND_BLOCKS blocks, newest at slot newest
+    std::array<float, TREND_BLOCKS> levels{};
+    std::array<float, TREND_BLOCKS> octaves{};
+    std::array<float, TREND_BLOCKS> rates{};
+    size_t newest = 0;
+    size_t blockCount = 0;
+
+    bool armed = false;
+    float buildStartLevel = 0.0f;
+    bool hasTarget = false;
+    float targetLevel = 0.0f;                            // Level the last build-up peaked at
+    float probability = 0.0f;
+    float countdown = 0.0f;
+
+    // Least-squares slope per second of a ring, oldest to newest
+    float slope(const std::array<float, TREND_BLOCKS>& values) const;
+
+public:
+    const char* getName() const override { return "drop"; }
+    std::vector<std::string> getInputs() const override { return { "rms", "centroid", "onset" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+    double getSettleSeconds() const override;
+    size_t getBlockFrames() const override { return blockHops; }
+};
+
+#endif // STRUCTURE_NODES_HPP
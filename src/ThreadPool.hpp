@@ -0,0 +1,63 @@
+// ThreadPool.hpp
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool for offline analysis. Each worker owns a task deque:
+// it pushes and pops its own work at the back (newest first, so nested work
+// stays cache-warm) and, when empty, steals the oldest task from the front of
+// another worker's deque. Tasks may submit more tasks, which is how a file
+// task fans out into chunk tasks without blocking a worker.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex stateMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+    size_t pending;            // Submitted and not yet finished, guarded by stateMutex
+    size_t queued;             // Sitting in a deque, guarded by stateMutex
+    bool stopping;
+    std::atomic<size_t> nextWorker;
+
+    bool popLocal(size_t index, Task& task);
+    bool steal(size_t thief, Task& task);
+    void run(size_t index);
+
+public:
+    // threadCount 0 uses every hardware thread
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // From a worker the task goes on that worker's own deque, otherwise
+    // the deques are filled round-robin
+    void submit(Task task);
+
+    // Blocks until every submitted task, including ones they submitted, has run
+    void wait();
+
+    size_t getThreadCount() const { return threads.size(); }
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,183 @@
+// TimelineFollower.cpp
+#include "TimelineFollower.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+const float TimelineFollower::BAND_SECONDS = 8.0f;
+const float TimelineFollower::ENERGY_FLOOR = 1e-3f;
+const double TimelineFollower::STEP_PENALTY = 0.5;
+
+namespace {
+
+const double UNREACHABLE = std::numeric_limits<double>::infinity();
+
+} // namespace
+
+TimelineFollower::TimelineFollower(const std::vector<float>& features, size_t dimensions, unsigned int sampleRate,
+                                   unsigned int hopSize)
+    : dimensions(dimensions)
+    , frameCount(dimensions ? features.size() / dimensions : 0)
+    , reference(frameCount * dimensions)
+    , live(dimensions)
+{
+    if (frameCount == 0) {
+        throw std::runtime_error("Reference timeline is empty");
+    }
+    for (size_t i = 0; i < frameCount; ++i) {
+        normalise(features.data() + i * dimensions, reference.data() + i * dimensions, dimensions);
+    }
+    size_t band = static_cast<size_t>(BAND_SECONDS * sampleRate / hopSize);
+    bandWidth = std::clamp<size_t>(band, 2, frameCount);
+    previousRow.resize(bandWidth);
+    currentRow.resize(bandWidth);
+    reset();
+}
+
+void TimelineFollower::reset() {
+    std::fill(previousRow.begin(), previousRow.end(), UNREACHABLE);
+    previousStart = 0;
+    bandStart = 0;
+    liveFrames = 0;
+    position = 0;
+    pathCost = 0.0f;
+}
+
+void TimelineFollower::normalise(const float* input, float* output, size_t count) {
+    float total = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        total += std::max(input[i], 0.0f);
+    }
+    // Silence stays all-zero, i.e. equally far from everything
+    if (total <= 1e-9f) {
+        std::fill(output, output + count, 0.0f);
+        return;
+    }
+
+    // Log of each band's share of the energy, floored, with the mean removed:
+    // only the spectral shape is compared, not the level
+    float mean = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        output[i] = std::log(std::max(input[i], 0.0f) / total + ENERGY_FLOOR);
+        mean += output[i];
+    }
+    mean /= count;
+    float sumSquares = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        output[i] -= mean;
+        sumSquares += output[i] * output[i];
+    }
+    float scale = sumSquares > 1e-12f ? 1.0f / std::sqrt(sumSquares) : 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        output[i] *= scale;
+    }
+}
+
+size_t TimelineFollower::addFrame(const float* features) {
+    normalise(features, live.data(), dimensions);
+
+    // Accumulated cost of reference frame j in the previous row
+    auto previous = [&](size_t j) {
+        return j >= previousStart && j - previousStart < bandWidth ? previousRow[j - previousStart] : UNREACHABLE;
+    };
+
+    // Symmetric step weights (diagonal counts twice), so every path to cell
+    // (t, j) has total weight t + j + 1 and cells can be compared by their
+    // cost per unit weight. Off-diagonal steps pay a penalty on top, which
+    // keeps the path from racing ahead through similar-sounding passages.
+    size_t best = bandStart;
+    double bestCost = UNREACHABLE;
+    for (size_t k = 0; k < bandWidth; ++k) {
+        size_t j = bandStart + k;
+        const float* frame = reference.data() + j * dimensions;
+        float dot = 0.0f;
+        for (size_t d = 0; d < dimensions; ++d) {
+            dot += live[d] * frame[d];
+        }
+        double distance = 1.0 - dot;
+
+        double cost;
+        if (liveFrames == 0 && j == 0) {
+            cost = distance;
+        }
+        else {
+            cost = previous(j) + distance + STEP_PENALTY;
+            if (j > 0) {
+                cost = std::min(cost, previous(j - 1) + 2.0 * distance);
+            }
+            if (k > 0) {
+                cost = std::min(cost, currentRow[k - 1] + distance + STEP_PENALTY);
+            }
+        }
+        currentRow[k] = cost;
+
+        double normalised = cost / static_cast<double>(liveFrames + j + 1);
+        if (normalised < bestCost) {
+            bestCost = normalised;
+            best = j;
+        }
+    }
+
+    previousRow.swap(currentRow);
+    previousStart = bandStart;
+    ++liveFrames;
+    position = best;
+    pathCost = static_cast<float>(bestCost);
+
+    // Centre the next band on the best match. It never moves backwards, so
+    // the reference position cannot run away to an earlier repeat.
+    size_t centred = best > bandWidth / 2 ? best - bandWidth / 2 : 0;
+    bandStart = std::min(std::max(bandStart, centred), frameCount - bandWidth);
+    return position;
+}
+
+TimelineFollowNode::TimelineFollowNode(const std::string& timelinePath)
+    : timelinePath(timelinePath)
+{
+}
+
+size_t TimelineFollowNode::prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) {
+    FeatureTimeline timeline;
+    std::string error;
+    if (!timeline.open(timelinePath, error)) {
+        throw std::runtime_error(error);
+    }
+    if (timeline.getSampleRate() != context.sampleRate || timeline.getHopSize() != context.hopSize) {
+        throw std::runtime_error(timelinePath + " was analysed at " + std::to_string(timeline.getSampleRate())
+                                 + " Hz, hop " + std::to_string(timeline.getHopSize())
+                                 + "; the analysis settings must match");
+    }
+
+    // Copy the mel columns into rows; the follower reads whole frames at a time
+    size_t dimensions = inputSizes[0];
+    size_t rows = timeline.getRowCount();
+    std::vector<float> features(rows * dimensions);
+    for (size_t d = 0; d < dimensions; ++d) {
+        size_t column = timeline.findColumn("mel_bands[" + std::to_string(d) + "]");
+        if (column == FeatureTimeline::NO_COLUMN) {
+            throw std::runtime_error(timelinePath + " has no mel_bands; analyse it with --features mel_bands");
+        }
+        std::span<const float> values = timeline.getColumn(column);
+        for (size_t row = 0; row < rows; ++row) {
+            features[row * dimensions + d] = values[row];
+        }
+    }
+    times.assign(timeline.getTimes().begin(), timeline.getTimes().end());
+
+    follower = std::make_unique<TimelineFollower>(features, dimensions, context.sampleRate,
+                                                  static_cast<unsigned int>(context.hopSize));
+    return 2;
+}
+
+void TimelineFollowNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    size_t row = follower->addFrame(inputs[0].data());
+    output[0] = static_cast<float>(times[row]);
+    output[1] = follower->getPathCost();
+}
+
+void TimelineFollowNode::reset() {
+    if (follower) {
+        follower->reset();
+    }
+}
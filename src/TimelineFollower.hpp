@@ -0,0 +1,79 @@
+// TimelineFollower.hpp
+#ifndef TIMELINE_FOLLOWER_HPP
+#define TIMELINE_FOLLOWER_HPP
+
+#include "FeatureGraph.hpp"
+#include "FeatureTimeline.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Online dynamic time warping against a reference performance. Each live
+// frame adds one row of the cost matrix, but only for a fixed-width band of
+// reference frames around the current position, and only the previous row is
+// kept. Cost per frame and memory are therefore constant however long the
+// song is, while the band still lets the live tempo drift either way.
+class TimelineFollower {
+private:
+    static const float BAND_SECONDS;       // Width of the band of reference frames searched
+    static const float ENERGY_FLOOR;       // Relative band energy treated as silent
+    static const double STEP_PENALTY;      // Extra cost of a tempo change step
+
+    size_t dimensions;
+    size_t frameCount;
+    std::vector<float> reference;          // frameCount x dimensions, normalised
+    size_t bandWidth;
+
+    // Accumulated cost of the previous and current row, over reference frames
+    // [previousStart, previousStart + bandWidth) and [bandStart, ...)
+    std::vector<double> previousRow;
+    std::vector<double> currentRow;
+    size_t previousStart;
+    size_t bandStart;
+    std::vector<float> live;               // Normalised incoming frame
+    size_t liveFrames;
+
+    size_t position;
+    float pathCost;
+
+    // Reduces a frame to its spectral shape, so level differences between
+    // the studio and the stage do not count as mismatches
+    static void normalise(const float* input, float* output, size_t count);
+
+public:
+    // features: frameCount x dimensions, row-major, as produced by the live analysis
+    TimelineFollower(const std::vector<float>& features, size_t dimensions, unsigned int sampleRate,
+                     unsigned int hopSize);
+
+    // Aligns one live frame and returns the matching reference frame
+    size_t addFrame(const float* features);
+    void reset();
+
+    size_t getPosition() const { return position; }
+    // Mean cost per step along the best path, for diagnostics
+    float getPathCost() const { return pathCost; }
+    size_t getBandWidth() const { return bandWidth; }
+};
+
+// Graph node following a pre-analysed timeline (AnalysisConfig::followTimeline)
+// with the live mel bands. Output: [reference position in seconds, path cost].
+// The timeline must have been analysed with mel_bands at the live frame, hop
+// and analysis rate; prepare() throws otherwise.
+class TimelineFollowNode : public FeatureNode {
+private:
+    std::string timelinePath;
+    std::vector<double> times;
+    std::unique_ptr<TimelineFollower> follower;
+
+public:
+    explicit TimelineFollowNode(const std::string& timelinePath);
+
+    const char* getName() const override { return "timeline_follow"; }
+    std::vector<std::string> getInputs() const override { return { "mel_bands" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+};
+
+#endif // TIMELINE_FOLLOWER_HPP
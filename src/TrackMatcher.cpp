@@ -0,0 +1,178 @@
+// TrackMatcher.cpp
+#include "TrackMatcher.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+const float TrackMatcher::VOTE_SECONDS = 8.0f;
+const float TrackMatcher::LOST_SECONDS = 6.0f;
+
+TrackMatcher::TrackMatcher(const FingerprintIndex& index, unsigned int sampleRate, unsigned int hopSize)
+    : index(index)
+    , hopSeconds(static_cast<double>(hopSize) / sampleRate)
+    , voteFrames(static_cast<std::uint32_t>(VOTE_SECONDS / hopSeconds))
+    , lostFrames(static_cast<std::uint32_t>(LOST_SECONDS / hopSeconds))
+    , votes(VOTE_SLOTS)
+    , spare(VOTE_SLOTS)
+{
+    reset();
+}
+
+void TrackMatcher::reset() {
+    std::fill(votes.begin(), votes.end(), Vote{});
+    usedSlots = 0;
+    lastSweep = 0;
+    matched = false;
+    matchTrack = 0;
+    matchOffset = 0;
+    matchVotes = 0;
+    lastConfirmed = 0;
+}
+
+TrackMatcher::Vote* TrackMatcher::findSlot(std::vector<Vote>& table, std::uint32_t track, std::int32_t offset) {
+    // Linear probing; returns the matching slot or the first free one
+    std::uint32_t hash = (track * 2654435761u) ^ (static_cast<std::uint32_t>(offset) * 40503u);
+    size_t mask = VOTE_SLOTS - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Vote& vote = table[i];
+        if (!vote.used || (vote.track == track && vote.offset == offset)) {
+            return &vote;
+        }
+    }
+}
+
+std::uint32_t TrackMatcher::countAt(std::uint32_t track, std::int32_t offset) {
+    Vote* vote = findSlot(votes, track, offset);
+    return vote->used ? vote->count : 0;
+}
+
+void TrackMatcher::sweep(std::uint32_t currentFrame) {
+    // Rebuild the table without votes that have gone stale
+    std::fill(spare.begin(), spare.end(), Vote{});
+    size_t kept = 0;
+    for (const Vote& vote : votes) {
+        if (vote.used && currentFrame - vote.lastFrame <= voteFrames) {
+            *findSlot(spare, vote.track, vote.offset) = vote;
+            ++kept;
+        }
+    }
+    votes.swap(spare);
+    usedSlots = kept;
+    lastSweep = currentFrame;
+
+    // Still crowded: everything is noise, start over
+    if (usedSlots > VOTE_SLOTS / 2) {
+        std::fill(votes.begin(), votes.end(), Vote{});
+        usedSlots = 0;
+    }
+}
+
+void TrackMatcher::addLandmarks(const Landmark* landmarks, size_t count, std::uint32_t currentFrame) {
+    if (currentFrame - lastSweep > voteFrames / 2) {
+        sweep(currentFrame);
+    }
+
+    for (size_t l = 0; l < count; ++l) {
+        std::span<const FingerprintEntry> hits = index.lookup(landmarks[l].hash);
+        if (hits.size() > MAX_ENTRIES_PER_HASH) {
+            continue;
+        }
+        for (const FingerprintEntry& hit : hits) {
+            std::int32_t offset = static_cast<std::int32_t>(hit.frame) - static_cast<std::int32_t>(landmarks[l].frame);
+            if (usedSlots >= VOTE_SLOTS * 3 / 4) {
+                sweep(currentFrame);
+            }
+            Vote* vote = findSlot(votes, hit.track, offset);
+            if (!vote->used) {
+                *vote = Vote{ hit.track, offset, 0, currentFrame, true };
+                ++usedSlots;
+            }
+            ++vote->count;
+            vote->lastFrame = currentFrame;
+
+            // Live frames can land either side of the offline hop grid, so
+            // neighbouring offsets count towards the same alignment
+            std::uint32_t score = vote->count + countAt(hit.track, offset - 1) + countAt(hit.track, offset + 1);
+            if (score < MATCH_VOTES) {
+                continue;
+            }
+
+            bool sameAlignment = matched && hit.track == matchTrack && std::abs(offset - matchOffset) <= 1;
+            if (sameAlignment) {
+                if (vote->count >= countAt(matchTrack, matchOffset)) {
+                    matchOffset = offset;
+                }
+                matchVotes = std::max(matchVotes, score);
+                lastConfirmed = currentFrame;
+            }
+            else if (!matched || score > 2 * countAt(matchTrack, matchOffset) + MATCH_VOTES) {
+                // First match, or the DJ has clearly moved on to another track or position
+                matched = true;
+                matchTrack = hit.track;
+                matchOffset = offset;
+                matchVotes = score;
+                lastConfirmed = currentFrame;
+            }
+        }
+    }
+
+    if (matched && currentFrame - lastConfirmed > lostFrames) {
+        matched = false;
+        matchVotes = 0;
+    }
+}
+
+TrackMatch TrackMatcher::getMatch(std::uint32_t currentFrame) const {
+    TrackMatch match;
+    if (!matched) {
+        return match;
+    }
+    match.matched = true;
+    match.track = matchTrack;
+    match.votes = matchVotes;
+    std::int64_t referenceFrame = static_cast<std::int64_t>(currentFrame) + matchOffset;
+    match.position = std::max<std::int64_t>(0, referenceFrame + 1) * hopSeconds;
+    return match;
+}
+
+TrackMatchNode::TrackMatchNode(const std::string& indexPath)
+    : indexPath(indexPath)
+    , landmarks{}
+    , frame(0)
+{
+}
+
+size_t TrackMatchNode::prepare(const FrameContext& context, const std::vector<size_t>&) {
+    std::string error;
+    if (!index.open(indexPath, error)) {
+        throw std::runtime_error(error);
+    }
+    if (index.getSampleRate() != context.sampleRate || index.getHopSize() != context.hopSize
+        || index.getFrameSize() != context.frameSize) {
+        throw std::runtime_error(indexPath + " was built for " + std::to_string(index.getSampleRate()) + " Hz, frame "
+                                 + std::to_string(index.getFrameSize()) + ", hop " + std::to_string(index.getHopSize())
+                                 + "; the analysis settings must match");
+    }
+    fingerprinter = std::make_unique<Fingerprinter>(context.frameSize, context.sampleRate);
+    matcher = std::make_unique<TrackMatcher>(index, context.sampleRate, static_cast<unsigned int>(context.hopSize));
+    return 3;
+}
+
+void TrackMatchNode::process(const NodeInputs& inputs, std::span<float> output, FrameArena&) {
+    size_t count = fingerprinter->addFrame(inputs[0].data(), frame, landmarks.data());
+    matcher->addLandmarks(landmarks.data(), count, frame);
+
+    TrackMatch match = matcher->getMatch(frame);
+    output[0] = match.matched ? static_cast<float>(match.track + 1) : 0.0f;
+    output[1] = static_cast<float>(match.position);
+    output[2] = static_cast<float>(match.votes);
+    ++frame;
+}
+
+void TrackMatchNode::reset() {
+    if (fingerprinter) {
+        fingerprinter->reset();
+        matcher->reset();
+    }
+    frame = 0;
+}
@@ -0,0 +1,93 @@
+// TrackMatcher.hpp
+#ifndef TRACK_MATCHER_HPP
+#define TRACK_MATCHER_HPP
+
+#include "FeatureGraph.hpp"
+#include "FingerprintIndex.hpp"
+#include "Fingerprinter.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct TrackMatch {
+    bool matched = false;
+    std::uint32_t track = 0;
+    double position = 0.0;    // Seconds into the reference track
+    std::uint32_t votes = 0;
+};
+
+// Recognises pre-analysed tracks from live landmarks. Every landmark hit in
+// the index votes for (track, reference frame - live frame); a true match
+// piles votes onto one time offset while chance hits scatter. Votes live in a
+// fixed open-addressing table and expire after a few seconds, so memory and
+// per-frame cost stay bounded for the whole show.
+class TrackMatcher {
+private:
+    static const size_t VOTE_SLOTS = 4096;               // Power of two
+    static const std::uint32_t MATCH_VOTES = 10;         // Aligned hits needed to declare a match
+    static const size_t MAX_ENTRIES_PER_HASH = 64;       // Hashes more common than this carry no information
+    static const float VOTE_SECONDS;
+    static const float LOST_SECONDS;
+
+    struct Vote {
+        std::uint32_t track;
+        std::int32_t offset;
+        std::uint32_t count;
+        std::uint32_t lastFrame;
+        bool used;
+    };
+
+    const FingerprintIndex& index;
+    double hopSeconds;
+    std::uint32_t voteFrames;
+    std::uint32_t lostFrames;
+
+    std::vector<Vote> votes;
+    std::vector<Vote> spare;      // Rebuild target when expiring votes
+    size_t usedSlots;
+    std::uint32_t lastSweep;
+
+    bool matched;
+    std::uint32_t matchTrack;
+    std::int32_t matchOffset;
+    std::uint32_t matchVotes;
+    std::uint32_t lastConfirmed;
+
+    Vote* findSlot(std::vector<Vote>& table, std::uint32_t track, std::int32_t offset);
+    std::uint32_t countAt(std::uint32_t track, std::int32_t offset);
+    void sweep(std::uint32_t currentFrame);
+
+public:
+    TrackMatcher(const FingerprintIndex& index, unsigned int sampleRate, unsigned int hopSize);
+
+    void addLandmarks(const Landmark* landmarks, size_t count, std::uint32_t currentFrame);
+    TrackMatch getMatch(std::uint32_t currentFrame) const;
+    void reset();
+};
+
+// Graph node running fingerprinting and matching on the live magnitude
+// spectrum. Output: [matched track + 1 (0 = none), reference position in
+// seconds, votes]. The index must have been built with the same frame size,
+// hop and analysis rate; prepare() throws otherwise.
+class TrackMatchNode : public FeatureNode {
+private:
+    std::string indexPath;
+    FingerprintIndex index;
+    std::unique_ptr<Fingerprinter> fingerprinter;
+    std::unique_ptr<TrackMatcher> matcher;
+    std::array<Landmark, Fingerprinter::MAX_LANDMARKS_PER_FRAME> landmarks;
+    std::uint32_t frame;
+
+public:
+    explicit TrackMatchNode(const std::string& indexPath);
+
+    const char* getName() const override { return "track_match"; }
+    std::vector<std::string> getInputs() const override { return { "magnitude" }; }
+    size_t prepare(const FrameContext& context, const std::vector<size_t>& inputSizes) override;
+    void process(const NodeInputs& inputs, std::span<float> output, FrameArena& scratch) override;
+    void reset() override;
+};
+
+#endif // TRACK_MATCHER_HPP
@@ -0,0 +1,121 @@
+// WavReader.cpp
+#include "WavReader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    std::uint32_t readU32(const unsigned char* p) {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+    }
+
+    std::uint16_t readU16(const unsigned char* p) {
+        return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    const std::uint16_t FORMAT_PCM = 1;
+    const std::uint16_t FORMAT_FLOAT = 3;
+    const std::uint16_t FORMAT_EXTENSIBLE = 0xFFFE;
+}
+
+WavReader::WavReader()
+    : sampleRate(0)
+    , channelCount(0)
+{
+}
+
+bool WavReader::load(const std::string& path) {
+    samples.clear();
+    error.clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "Could not open " + path;
+        return false;
+    }
+
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < 12 || std::memcmp(data.data(), "RIFF", 4) != 0 || std::memcmp(data.data() + 8, "WAVE", 4) != 0) {
+        error = path + " is not a RIFF/WAVE file";
+        return false;
+    }
+
+    std::uint16_t format = 0;
+    std::uint16_t bitsPerSample = 0;
+    const unsigned char* pcm = nullptr;
+    size_t pcmBytes = 0;
+
+    // Walk the chunk list; chunks are padded to even sizes
+    size_t pos = 12;
+    while (pos + 8 <= data.size()) {
+        const unsigned char* chunk = data.data() + pos;
+        std::uint32_t chunkSize = readU32(chunk + 4);
+        size_t available = std::min<size_t>(chunkSize, data.size() - pos - 8);
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+            format = readU16(chunk + 8);
+            channelCount = readU16(chunk + 10);
+            sampleRate = readU32(chunk + 12);
+            bitsPerSample = readU16(chunk + 22);
+            if (format == FORMAT_EXTENSIBLE && available >= 26) {
+                format = readU16(chunk + 32);  // First two bytes of the sub-format GUID
+            }
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0) {
+            pcm = chunk + 8;
+            pcmBytes = available;
+        }
+
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (pcm == nullptr || channelCount == 0 || sampleRate == 0) {
+        error = path + " has no usable fmt/data chunks";
+        return false;
+    }
+
+    size_t bytesPerSample = bitsPerSample / 8;
+    bool supported = (format == FORMAT_PCM && (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32))
+                  || (format == FORMAT_FLOAT && bitsPerSample == 32);
+    if (!supported) {
+        error = path + " uses an unsupported sample format";
+        return false;
+    }
+
+    size_t count = pcmBytes / bytesPerSample;
+    count -= count % channelCount;
+    samples.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned char* p = pcm + i * bytesPerSample;
+        if (format == FORMAT_FLOAT) {
+            float value;
+            std::memcpy(&value, p, sizeof(value));
+            value = std::clamp(value, -1.0f, 1.0f);
+            samples[i] = static_cast<std::int16_t>(value * 32767.0f);
+        }
+        else {
+            // Keep the top 16 bits of wider integer formats
+            samples[i] = static_cast<std::int16_t>(readU16(p + bytesPerSample - 2));
+        }
+    }
+
+    return true;
+}
+
+std::vector<std::int16_t> WavReader::getMonoSamples() const {
+    if (channelCount <= 1) {
+        return samples;
+    }
+
+    size_t frames = getFrameCount();
+    std::vector<std::int16_t> mono(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        int sum = 0;
+        for (unsigned int c = 0; c < channelCount; ++c) {
+            sum += samples[i * channelCount + c];
+        }
+        mono[i] = static_cast<std::int16_t>(sum / static_cast<int>(channelCount));
+    }
+    return mono;
+}
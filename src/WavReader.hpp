@@ -0,0 +1,34 @@
+// WavReader.hpp
+#ifndef WAV_READER_HPP
+#define WAV_READER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Minimal RIFF/WAVE loader for offline analysis. Supports 16/24/32-bit integer
+// PCM and 32-bit float; everything is converted to interleaved 16-bit samples,
+// the format the live capture path delivers.
+class WavReader {
+private:
+    unsigned int sampleRate;
+    unsigned int channelCount;
+    std::vector<std::int16_t> samples;
+    std::string error;
+
+public:
+    WavReader();
+
+    bool load(const std::string& path);
+
+    // Averages all channels into a single mono stream
+    std::vector<std::int16_t> getMonoSamples() const;
+
+    unsigned int getSampleRate() const { return sampleRate; }
+    unsigned int getChannelCount() const { return channelCount; }
+    size_t getFrameCount() const { return channelCount ? samples.size() / channelCount : 0; }
+    const std::vector<std::int16_t>& getSamples() const { return samples; }
+    const std::string& getError() const { return error; }
+};
+
+#endif // WAV_READER_HPP
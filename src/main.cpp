@@ -1,13 +1,27 @@
 #include "WindowDisplayController.hpp"
 #include "AudioAnalyzer.hpp"
+#include "LightingEngine.hpp"
 #include "MessageBox.hpp"
+#include <filesystem>
 
 int main() {
     try {
+        // Load analysis settings if present; defaults otherwise
+        AnalysisConfig analysisConfig;
+        const std::string configPath = "analysis.cfg";
+        std::string configError;
+        if (std::filesystem::exists(configPath) && !analysisConfig.loadFromFile(configPath, configError)) {
+            MessageBox errorMsg("Invalid analysis settings:\n" + configError);
+            errorMsg.show();
+            return -1;
+        }
+
         // Create window
         sf::RenderWindow window(sf::VideoMode(800, 600), "Audio Reactive Display");
         WindowDisplayController displayController(window);
-        AudioAnalyzer audioAnalyzer;
+        AudioAnalyzer audioAnalyzer(analysisConfig);
+        LightingEngine lightingEngine(1, 5);  // Wash on channels 1-4, strobe on 5
+        DmxFrame dmxFrame;
 
         // Show startup message
         MessageBox startMsg("Starting Audio Analyzer...\nPlease wait.");
@@ -28,9 +42,8 @@ int main() {
             }
 
             audioAnalyzer.update();
-            float spectralCentroid = audioAnalyzer.getSpectralCentroid();
-            float volume = audioAnalyzer.getVolume();
-            displayController.updateDisplay(spectralCentroid, volume);
+            lightingEngine.render(audioAnalyzer.getSnapshot(), dmxFrame);
+            displayController.updateDisplay(lightingEngine.getPreviewColor());
         }
 
     }
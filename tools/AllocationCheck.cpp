@@ -0,0 +1,164 @@
+// AllocationCheck.cpp
+// Self-contained check that the live analysis loop stays off the heap. It
+// synthesises thirty seconds of room noise and a simple beat with chords, a
+// drop and a pause, then feeds them through the pipeline and lighting in
+// capture-sized blocks exactly as InputAnalyzer does, with the allocation
+// tracker armed across pushSamples(), processHop() and render() after the
+// warm-up. Several configurations cover resampling, the tonal graph, every
+// standard feature and the noise gate. Needs a build with
+// -DIML_TRACK_ALLOCATIONS; exits with code 3 if anything allocated.
+
+#include "AllocationTracker.hpp"
+#include "AnalysisPipeline.hpp"
+#include "LightingEngine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const unsigned int INPUT_RATE = 44100;    // Resampled to each configuration's analysis rate
+const double SECONDS = 30.0;
+const size_t BLOCK_SAMPLES = 441;         // 10 ms, as CaptureStream delivers
+const size_t WARMUP_HOPS = 16;            // As InputAnalyzer
+
+struct CheckCase {
+    const char* name;
+    AnalysisConfig config;
+};
+
+// Room noise, then four-on-the-floor kicks, off-beat hats and a triad that
+// changes every two seconds; louder with more bass from 17 s (a drop), and
+// a pause back to the room noise from 24 to 27 s
+std::vector<std::int16_t> synthesise() {
+    const double pi = 3.14159265358979323846;
+    const double roots[] = { 220.0, 174.61, 261.63, 196.0 };
+    std::vector<std::int16_t> samples(static_cast<size_t>(SECONDS * INPUT_RATE));
+    std::uint32_t seed = 12345;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        double t = static_cast<double>(i) / INPUT_RATE;
+        seed = seed * 1664525u + 1013904223u;
+        double noise = static_cast<double>(seed >> 8) / (1 << 24) * 2.0 - 1.0;
+        double value = 0.003 * noise;
+
+        if (t >= 3.0 && (t < 24.0 || t >= 27.0)) {
+            double gain = t >= 17.0 ? 1.0 : 0.5;
+            double beat = std::fmod(t, 0.5);
+            double kickPitch = 50.0 + 100.0 * std::exp(-beat * 40.0);
+            value += gain * 0.5 * std::exp(-beat * 12.0) * std::sin(2.0 * pi * kickPitch * beat);
+            double offBeat = std::fmod(t + 0.25, 0.5);
+            value += 0.15 * std::exp(-offBeat * 60.0) * noise;
+
+            double root = roots[static_cast<size_t>(t / 2.0) % 4];
+            for (double ratio : { 1.0, 1.26, 1.5 }) {
+                value += gain * 0.08 * std::sin(2.0 * pi * root * ratio * t);
+            }
+            if (t >= 17.0) {
+                value += 0.2 * std::sin(2.0 * pi * root / 4.0 * t);
+            }
+        }
+        samples[i] = static_cast<std::int16_t>(std::lround(std::max(-1.0, std::min(1.0, value)) * 32767.0));
+    }
+    return samples;
+}
+
+std::vector<CheckCase> makeCases() {
+    std::vector<CheckCase> cases;
+
+    AnalysisConfig lighting;
+    lighting.sampleRate = INPUT_RATE;
+    lighting.analysisRate = 48000;
+    cases.push_back({ "lighting, resampled to 48 kHz", lighting });
+
+    AnalysisConfig everything = lighting;
+    everything.tonalFrameSize = 4096;
+    everything.features = { "loudness", "flux", "onset", "mel_bands", "chroma", "key", "chord", "pitch",
+                            "hpss_energy", "drums", "crossover", "sections", "drop" };
+    everything.tones = { 55.0f, 110.0f, 220.0f };
+    everything.noiseSubtraction = 1.5f;
+    everything.normalizeFields = { { "band_levels", 5 }, { "chroma", 6 }, { "tones", 3 } };
+    cases.push_back({ "every feature, tonal graph, tones, noise subtraction, normalised fields", everything });
+
+    AnalysisConfig gated = lighting;
+    gated.analysisRate = 0;
+    gated.hopSize = 64;
+    gated.features = { "drums", "crossover", "sections", "drop" };
+    gated.noiseGate = 6.0f;
+    gated.noiseFloorSeconds = 10.0f;
+    cases.push_back({ "noise gate, 64-sample hops", gated });
+
+    return cases;
+}
+
+// Returns the steady-state allocation count of one configuration
+size_t runCase(const CheckCase& check, const std::vector<std::int16_t>& samples, size_t& hops) {
+    AnalysisPipeline pipeline(check.config, INPUT_RATE);
+    LightingEngine lighting(1, 5);
+    DmxFrame frame;
+
+    AllocationTracker::resetCount();
+    hops = 0;
+    for (size_t pos = 0; pos < samples.size(); pos += BLOCK_SAMPLES) {
+        const std::int16_t* block = samples.data() + pos;
+        size_t remaining = std::min(BLOCK_SAMPLES, samples.size() - pos);
+        if (hops >= WARMUP_HOPS) {
+            AllocationTracker::arm(false);
+        }
+        bool produced = false;
+        while (remaining > 0) {
+            size_t accepted = pipeline.pushSamples(block, remaining);
+            block += accepted;
+            remaining -= accepted;
+            while (pipeline.processHop()) {
+                produced = true;
+                ++hops;
+            }
+        }
+        if (produced) {
+            lighting.render(pipeline.collectSnapshot(), frame);
+        }
+        AllocationTracker::disarm();
+    }
+    return AllocationTracker::getCount();
+}
+
+} // namespace
+
+int main() {
+    if (!AllocationTracker::isEnabled()) {
+        std::cerr << "AllocationCheck needs a build with -DIML_TRACK_ALLOCATIONS\n";
+        return 1;
+    }
+
+    std::vector<std::int16_t> samples = synthesise();
+    int exitCode = 0;
+    for (const CheckCase& check : makeCases()) {
+        std::string error;
+        if (!check.config.validate(error)) {
+            std::cerr << check.name << ": " << error << "\n";
+            return 1;
+        }
+
+        size_t hops = 0;
+        size_t allocations = 0;
+        try {
+            allocations = runCase(check, samples, hops);
+        }
+        catch (const std::exception& e) {
+            AllocationTracker::disarm();
+            std::cerr << check.name << ": " << e.what() << "\n";
+            return 1;
+        }
+        std::cout << (allocations == 0 ? "ok    " : "FAIL  ") << check.name << ": " << allocations
+                  << " allocations over " << hops << " hops\n";
+        if (allocations > 0) {
+            exitCode = 3;
+        }
+    }
+    return exitCode;
+}
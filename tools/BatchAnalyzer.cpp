@@ -0,0 +1,404 @@
+// BatchAnalyzer.cpp
+// Pre-analyses every WAV file in a directory (e.g. a tour setlist) ahead of
+// time and writes one feature timeline (FeatureTimeline.hpp) per track. Tracks are split into chunks
+// that run in parallel on a work-stealing thread pool, so a handful of long
+// tracks keeps every core busy just as well as many short ones.
+//
+// Each chunk runs its own AnalysisPipeline, starting PREROLL_SECONDS early so
+// the smoothing, flux and onset state has settled by the time its first hop
+// is kept, or earlier when a scheduled node remembers more (the key, sections
+// and drop nodes, short-term loudness). Results therefore match a single
+// serial pass to within the replay tolerance; --chunk-seconds 0 analyses each
+// track in one piece instead.
+// Adaptive normalisation moves the start back further, to a window boundary,
+// so the quantile sketches see exactly the values a serial pass gives them.
+//
+// With --fingerprint the landmarks of every track also go into one
+// fingerprint index, which the live app uses to recognise the tracks.
+
+#include "AnalysisPipeline.hpp"
+#include "FeatureTimeline.hpp"
+#include "FingerprintIndex.hpp"
+#include "Fingerprinter.hpp"
+#include "Resampler.hpp"
+#include "ThreadPool.hpp"
+#include "WavReader.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const double PREROLL_SECONDS = 2.0;
+
+struct TrackJob {
+    std::filesystem::path input;
+    std::filesystem::path output;
+    AnalysisConfig config;             // sampleRate set from the file once loaded
+
+    std::vector<std::int16_t> samples; // Mono, already at the analysis rate
+    std::vector<FeatureSnapshot> snapshots;
+    std::atomic<size_t> chunksLeft{ 0 };
+    std::vector<std::vector<Landmark>> chunkLandmarks;   // Only when fingerprinting
+
+    size_t hopCount = 0;
+    double audioSeconds = 0.0;
+    std::string error;
+};
+
+struct BatchSettings {
+    AnalysisConfig config;
+    double chunkSeconds = 30.0;
+    std::filesystem::path fingerprintIndex;
+};
+
+std::mutex outputMutex;
+
+void report(const TrackJob& job) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    if (!job.error.empty()) {
+        std::cerr << job.input.filename().string() << ": " << job.error << "\n";
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(1) << std::setw(8) << job.audioSeconds << " s  "
+              << std::setw(8) << job.snapshots.size() << " hops  " << job.output.string() << "\n";
+    std::cout.unsetf(std::ios::fixed);
+}
+
+void writeTrack(TrackJob& job) {
+    FeatureTimelineWriter writer(job.config.getAnalysisRate(), static_cast<unsigned int>(job.config.hopSize));
+    for (const FeatureSnapshot& snapshot : job.snapshots) {
+        writer.append(snapshot);
+    }
+    writer.save(job.output.string(), job.error);
+
+    report(job);
+    job.samples = std::vector<std::int16_t>();
+    job.snapshots = std::vector<FeatureSnapshot>();
+}
+
+// Analyses hops [firstHop, lastHop) of a track. Hop h covers the samples up
+// to (h + 1) * hopSize, exactly as in a pipeline started at sample 0.
+// Landmarks are kept if they are emitted while one of those hops is processed.
+void analyseChunk(TrackJob& job, size_t chunk, size_t firstHop, size_t lastHop) {
+    const AnalysisConfig& config = job.config;
+    unsigned int rate = config.getAnalysisRate();
+    AnalysisPipeline pipeline(config, rate);
+
+    // Long enough for the flux and onset state, and for whatever the
+    // scheduled nodes remember
+    double prerollSeconds = std::max(PREROLL_SECONDS, pipeline.getSettleSeconds());
+    size_t prerollHops = static_cast<size_t>(prerollSeconds * rate / config.hopSize) + 1;
+    size_t startHop = firstHop > prerollHops ? firstHop - prerollHops : 0;
+
+    // Tonal frames and the blocks of structure nodes are counted from the
+    // pipeline start, so the chunk has to start on a boundary of each.
+    // The normalisation ranges restart every window, counted from the first
+    // full frame. Starting a whole number of each window in, at least a
+    // preroll before the restart of the sketches that answer at firstHop,
+    // gives them exactly a serial run's state.
+    size_t alignment = pipeline.getAlignmentHops();
+    size_t firstFull = config.getFirstFullHop();
+    for (size_t windowHops : config.getNormalizeWindows()) {
+        size_t windows = firstHop >= firstFull ? (firstHop - firstFull) / windowHops : 0;
+        size_t restart = windows > 0 ? (windows - 1) * windowHops : 0;
+        size_t latest = restart >= prerollHops ? (restart - prerollHops) / windowHops * windowHops : 0;
+        startHop = std::min(startHop, latest);
+        alignment = std::lcm(alignment, windowHops);
+    }
+    startHop = startHop / alignment * alignment;
+
+    const std::int16_t* samples = job.samples.data();
+    size_t pos = startHop * config.hopSize;
+    size_t end = lastHop * config.hopSize;
+    size_t hop = startHop;
+
+    bool fingerprinting = !job.chunkLandmarks.empty();
+    Fingerprinter fingerprinter(config.frameSize, rate);
+    Landmark landmarks[Fingerprinter::MAX_LANDMARKS_PER_FRAME];
+    size_t magnitudeNode = pipeline.getGraph().findScheduled("magnitude");
+
+    while (hop < lastHop) {
+        size_t accepted = pipeline.pushSamples(samples + pos, std::min<size_t>(4096, end - pos));
+        pos += accepted;
+        bool produced = false;
+        while (hop < lastHop && pipeline.processHop()) {
+            produced = true;
+            if (hop >= firstHop) {
+                FeatureSnapshot snapshot = pipeline.getSnapshot();
+                snapshot.time = static_cast<double>(hop + 1) * config.hopSize / rate;
+                job.snapshots[hop] = snapshot;
+            }
+            if (fingerprinting) {
+                const float* magnitudes = pipeline.getGraph().getOutput(magnitudeNode).data();
+                size_t count = fingerprinter.addFrame(magnitudes, static_cast<std::uint32_t>(hop), landmarks);
+                if (hop >= firstHop) {
+                    job.chunkLandmarks[chunk].insert(job.chunkLandmarks[chunk].end(), landmarks, landmarks + count);
+                }
+            }
+            ++hop;
+        }
+        if (accepted == 0 && !produced) {
+            break;   // Input exhausted
+        }
+    }
+}
+
+// Loads and resamples one track, then fans its chunks out to the pool. The
+// last chunk to finish writes the file.
+void analyseTrack(ThreadPool& pool, TrackJob& job, double chunkSeconds, bool fingerprinting) {
+    WavReader wav;
+    if (!wav.load(job.input.string())) {
+        job.error = wav.getError();
+        report(job);
+        return;
+    }
+
+    job.config.sampleRate = wav.getSampleRate();
+    std::string configError;
+    if (!job.config.validate(configError)) {
+        job.error = configError;
+        report(job);
+        return;
+    }
+
+    std::vector<std::int16_t> mono = wav.getMonoSamples();
+    job.audioSeconds = static_cast<double>(mono.size()) / wav.getSampleRate();
+
+    // Resample once up front so every chunk sees the same analysis-rate stream
+    Resampler resampler(wav.getSampleRate(), job.config.getAnalysisRate());
+    if (resampler.isPassthrough()) {
+        job.samples = std::move(mono);
+    }
+    else {
+        job.samples.resize(resampler.getMaxOutput(mono.size()));
+        job.samples.resize(resampler.process(mono.data(), mono.size(), job.samples.data(), job.samples.size()));
+    }
+
+    size_t hops = job.samples.size() / job.config.hopSize;
+    job.hopCount = hops;
+    job.snapshots.assign(hops, FeatureSnapshot());
+    if (hops == 0) {
+        writeTrack(job);
+        return;
+    }
+
+    size_t chunkHops = hops;
+    if (chunkSeconds > 0.0) {
+        chunkHops = std::max<size_t>(1, static_cast<size_t>(chunkSeconds * job.config.getAnalysisRate() / job.config.hopSize));
+    }
+    size_t chunks = (hops + chunkHops - 1) / chunkHops;
+    job.chunksLeft = chunks;
+    if (fingerprinting) {
+        job.chunkLandmarks.resize(chunks);
+    }
+
+    for (size_t c = 0; c < chunks; ++c) {
+        size_t firstHop = c * chunkHops;
+        size_t lastHop = std::min(hops, firstHop + chunkHops);
+        pool.submit([&job, c, firstHop, lastHop]() {
+            analyseChunk(job, c, firstHop, lastHop);
+            if (--job.chunksLeft == 0) {
+                writeTrack(job);
+            }
+        });
+    }
+}
+
+bool isWavFile(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".wav";
+}
+
+void printUsage() {
+    std::cout << "Usage: BatchAnalyzer <input dir> [options]\n"
+              << "  --out <dir>             Where feature files go (default features)\n"
+              << "  --threads <n>           Worker threads (default: all cores)\n"
+              << "  --chunk-seconds <s>     Audio per parallel chunk, 0 = whole tracks (default 30)\n"
+              << "  --config <file>         Analysis settings (sample_rate is taken from each file)\n"
+              << "  --analysis-rate <hz>    Resample every file to this rate before analysis\n"
+              << "  --frame <samples>       Analysis frame size (default 1024)\n"
+              << "  --hop <samples>         Analysis hop size (default 512)\n"
+              << "  --features <a,b,...>    Extra features to compute, e.g. flux,onset,mel_bands\n"
+              << "  --fingerprint <file>    Also build a fingerprint index for live track recognition\n"
+              << "                          (needs --analysis-rate matching the live analysis rate)\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    std::filesystem::path inputDir = argv[1];
+    std::filesystem::path outputDir = "features";
+    size_t threadCount = 0;
+    BatchSettings settings;
+    std::string configError;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--out" && hasValue) {
+            outputDir = argv[++i];
+        }
+        else if (arg == "--threads" && hasValue) {
+            threadCount = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--chunk-seconds" && hasValue) {
+            settings.chunkSeconds = std::atof(argv[++i]);
+        }
+        else if (arg == "--config" && hasValue) {
+            if (!settings.config.loadFromFile(argv[++i], configError)) {
+                std::cerr << configError << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--analysis-rate" && hasValue) {
+            settings.config.analysisRate = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--frame" && hasValue) {
+            settings.config.frameSize = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--hop" && hasValue) {
+            settings.config.hopSize = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--features" && hasValue) {
+            std::stringstream list(argv[++i]);
+            std::string feature;
+            while (std::getline(list, feature, ',')) {
+                settings.config.features.push_back(feature);
+            }
+        }
+        else if (arg == "--fingerprint" && hasValue) {
+            settings.fingerprintIndex = argv[++i];
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // Tracks are fingerprinted here, never matched or followed, and studio
+    // files have no room noise to learn
+    settings.config.fingerprintIndex.clear();
+    settings.config.followTimeline.clear();
+    settings.config.noiseGate = 0.0f;
+    settings.config.noiseSubtraction = 0.0f;
+    bool fingerprinting = !settings.fingerprintIndex.empty();
+    if (fingerprinting) {
+        if (settings.config.analysisRate == 0) {
+            std::cerr << "--fingerprint needs --analysis-rate (or analysis_rate in the config) so every "
+                         "track is indexed at the rate the live analysis runs at\n";
+            return 1;
+        }
+        settings.config.features.push_back("magnitude");
+    }
+
+    std::error_code fsError;
+    std::vector<std::filesystem::path> inputs;
+    for (const auto& entry : std::filesystem::directory_iterator(inputDir, fsError)) {
+        if (entry.is_regular_file() && isWavFile(entry.path())) {
+            inputs.push_back(entry.path());
+        }
+    }
+    if (fsError) {
+        std::cerr << "Could not read " << inputDir.string() << ": " << fsError.message() << "\n";
+        return 1;
+    }
+    if (inputs.empty()) {
+        std::cerr << "No .wav files in " << inputDir.string() << "\n";
+        return 1;
+    }
+    std::sort(inputs.begin(), inputs.end());
+    std::filesystem::create_directories(outputDir, fsError);
+
+    // Fail on bad features before any work is queued
+    try {
+        AnalysisPipeline probe(settings.config);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<TrackJob>> jobs;
+    for (const std::filesystem::path& input : inputs) {
+        auto job = std::make_unique<TrackJob>();
+        job->input = input;
+        job->output = outputDir / input.filename().replace_extension(".imft");
+        job->config = settings.config;
+        jobs.push_back(std::move(job));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    size_t threadsUsed = 0;
+    {
+        // Workers run their own newest task first, so a worker finishes the
+        // chunks of its current track before idle workers steal the next
+        // (oldest) track; only about one track per thread is in memory
+        ThreadPool pool(threadCount);
+        threadsUsed = pool.getThreadCount();
+        for (const std::unique_ptr<TrackJob>& job : jobs) {
+            TrackJob* track = job.get();
+            pool.submit([&pool, track, &settings, fingerprinting]() {
+                analyseTrack(pool, *track, settings.chunkSeconds, fingerprinting);
+            });
+        }
+        pool.wait();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double audioSeconds = 0.0;
+    size_t failed = 0;
+    for (const std::unique_ptr<TrackJob>& job : jobs) {
+        audioSeconds += job->audioSeconds;
+        failed += job->error.empty() ? 0 : 1;
+    }
+    std::cout << std::fixed << std::setprecision(1)
+              << "Analysed " << jobs.size() - failed << " of " << jobs.size() << " tracks ("
+              << audioSeconds << " s of audio) in " << std::setprecision(2) << elapsed << " s on "
+              << threadsUsed << " threads: " << std::setprecision(1)
+              << (elapsed > 0.0 ? audioSeconds / elapsed : 0.0) << "x real time\n";
+
+    if (fingerprinting) {
+        const AnalysisConfig& config = settings.config;
+        FingerprintIndexBuilder builder(config.analysisRate, static_cast<unsigned int>(config.hopSize),
+                                        static_cast<unsigned int>(config.frameSize));
+        std::filesystem::path indexDir = std::filesystem::absolute(settings.fingerprintIndex).parent_path();
+        size_t indexed = 0;
+        for (const std::unique_ptr<TrackJob>& job : jobs) {
+            if (!job->error.empty()) {
+                continue;
+            }
+            std::vector<Landmark> landmarks;
+            for (const std::vector<Landmark>& chunk : job->chunkLandmarks) {
+                landmarks.insert(landmarks.end(), chunk.begin(), chunk.end());
+            }
+            std::string timeline = std::filesystem::absolute(job->output).lexically_relative(indexDir).generic_string();
+            builder.addTrack(timeline, static_cast<std::uint32_t>(job->hopCount), landmarks);
+            ++indexed;
+        }
+        std::string indexError;
+        if (!builder.save(settings.fingerprintIndex.string(), indexError)) {
+            std::cerr << indexError << "\n";
+            return 1;
+        }
+        std::cout << "Fingerprint index of " << indexed << " tracks written to " << settings.fingerprintIndex.string() << "\n";
+    }
+    return failed == 0 ? 0 : 2;
+}
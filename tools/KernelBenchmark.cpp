@@ -0,0 +1,257 @@
+// KernelBenchmark.cpp
+// Headless micro-benchmarks for the analysis and colour kernels.
+// Only depends on the SFML-free sources in src/, so it builds on a box without
+// a display or audio device. See docs/setup.md for build instructions.
+
+#include "ColorConversion.hpp"
+#include "FeatureGraph.hpp"
+#include "FeatureNodes.hpp"
+#include "Resampler.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct BenchmarkResult {
+    std::string kernel;
+    size_t bufferSize;
+    size_t iterations;
+    double nsPerFrame;
+    double samplesPerSecond;
+};
+
+// Each graph feature is timed on its own, so its number includes everything it
+// depends on (e.g. centroid = window + fft + magnitude + centroid)
+const char* const GRAPH_FEATURES[] = {
+    "rms", "loudness", "window", "fft", "magnitude", "centroid", "mel_bands", "flux", "onset", "chroma", "key",
+    "chord", "pitch", "hpss", "hpss_energy", "drums", "crossover",
+    "sections", "drop"
+};
+
+// Keeps results observable so the optimiser cannot drop the kernel calls
+volatile float benchmarkSink = 0.0f;
+
+// Deterministic test signal: two tones plus LCG noise at roughly -12 dBFS
+std::vector<std::int16_t> makeTestSignal(size_t count) {
+    std::vector<std::int16_t> signal(count);
+    std::uint32_t seed = 12345u;
+    for (size_t i = 0; i < count; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        float noise = (static_cast<float>(seed >> 8) / 16777216.0f) * 2.0f - 1.0f;
+        float tone = 0.5f * std::sin(2.0f * 3.14159265f * 220.0f * i / 44100.0f)
+                   + 0.25f * std::sin(2.0f * 3.14159265f * 3520.0f * i / 44100.0f);
+        signal[i] = static_cast<std::int16_t>((tone * 0.25f + noise * 0.05f) * 32767.0f);
+    }
+    return signal;
+}
+
+// Runs the kernel repeatedly until minSeconds have elapsed and reports the mean
+BenchmarkResult runKernel(const std::string& name, size_t bufferSize, double minSeconds,
+                          const std::function<void()>& kernel) {
+    using Clock = std::chrono::steady_clock;
+
+    // Warm-up pass so first-touch page faults are not measured
+    kernel();
+
+    size_t iterations = 0;
+    size_t batch = 1;
+    Clock::time_point start = Clock::now();
+    double elapsed = 0.0;
+    while (elapsed < minSeconds) {
+        for (size_t i = 0; i < batch; ++i) {
+            kernel();
+        }
+        iterations += batch;
+        batch *= 2;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    BenchmarkResult result;
+    result.kernel = name;
+    result.bufferSize = bufferSize;
+    result.iterations = iterations;
+    result.nsPerFrame = elapsed * 1e9 / iterations;
+    result.samplesPerSecond = bufferSize * iterations / elapsed;
+    return result;
+}
+
+void writeJson(const std::string& path, const std::vector<BenchmarkResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Could not open " << path << " for writing\n";
+        return;
+    }
+
+    out << "{\n  \"benchmark\": \"kernels\",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        out << "    {\"kernel\": \"" << r.kernel << "\""
+            << ", \"buffer_size\": " << r.bufferSize
+            << ", \"iterations\": " << r.iterations
+            << std::fixed << std::setprecision(3)
+            << ", \"ns_per_frame\": " << r.nsPerFrame
+            << std::setprecision(1)
+            << ", \"samples_per_second\": " << r.samplesPerSecond << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+        out.unsetf(std::ios::fixed);
+    }
+    out << "  ]\n}\n";
+}
+
+void printUsage() {
+    std::cout << "Usage: KernelBenchmark [--json <file>] [--min-time <seconds>] [--filter <kernel>]\n"
+              << "Kernels: rms, loudness, window, fft, magnitude, centroid, mel_bands, flux, onset, chroma, key,\n"
+              << "         chord, pitch, hpss, hpss_energy, drums, crossover, sections, drop,\n"
+              << "         frame, frame_generic, all, tones_64, hsv_to_rgb, resample_96k_48k, resample_44k1_48k\n"
+              << "Feature kernels include their inputs. frame is what the lighting needs\n"
+              << "(rms + centroid), all is every feature in one graph. frame_generic forces\n"
+              << "the run-time sized kernels, for comparison with the compile-time\n"
+              << "specialisations used for 512-8192\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string jsonPath;
+    std::string filter;
+    double minSeconds = 0.2;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--min-time" && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        }
+        else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        }
+        else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    const size_t minSize = 256;
+    const size_t maxSize = 16384;
+    std::vector<std::int16_t> signal = makeTestSignal(maxSize);
+    std::vector<BenchmarkResult> results;
+
+    auto wanted = [&](const std::string& name) {
+        return filter.empty() || filter == name;
+    };
+
+    for (size_t size = minSize; size <= maxSize; size *= 2) {
+        FrameContext context;
+        context.frameSize = size;
+        context.hopSize = size / 2;
+        context.sampleRate = 44100;
+
+        // Builds a graph evaluating only the given features and times one frame
+        auto runGraph = [&](const std::string& name, const FrameContext& graphContext,
+                            const std::vector<std::string>& features) {
+            FeatureGraph graph(graphContext);
+            addStandardNodes(graph);
+            for (const std::string& feature : features) {
+                graph.subscribe(feature);
+            }
+            graph.compile();
+            size_t output = graph.findScheduled(features.front());
+            results.push_back(runKernel(name, size, minSeconds, [&]() {
+                graph.process(signal.data());
+                benchmarkSink = graph.getOutput(output)[0];
+            }));
+        };
+
+        for (const char* feature : GRAPH_FEATURES) {
+            if (wanted(feature)) {
+                runGraph(feature, context, { feature });
+            }
+        }
+        if (wanted("frame")) {
+            // Everything processHop() needs for the lighting
+            runGraph("frame", context, { "rms", "centroid" });
+        }
+        if (wanted("frame_generic")) {
+            FrameContext generic = context;
+            generic.genericKernels = true;
+            runGraph("frame_generic", generic, { "rms", "centroid" });
+        }
+        if (wanted("all")) {
+            runGraph("all", context, std::vector<std::string>(std::begin(GRAPH_FEATURES), std::end(GRAPH_FEATURES)));
+        }
+        if (wanted("tones_64")) {
+            // A full bank of tracked tones, the sample-by-sample alternative to fft
+            std::vector<float> tones;
+            for (size_t k = 0; k < 64; ++k) {
+                tones.push_back(40.0f * std::pow(2.0f, k / 12.0f));
+            }
+            FeatureGraph graph(context);
+            graph.addNode(std::make_unique<ToneNode>(tones, 0.05f));
+            graph.subscribe("tones");
+            graph.compile();
+            size_t output = graph.findScheduled("tones");
+            results.push_back(runKernel("tones_64", size, minSeconds, [&]() {
+                graph.process(signal.data());
+                benchmarkSink = graph.getOutput(output)[0];
+            }));
+        }
+        if (wanted("resample_96k_48k")) {
+            // Decimation ahead of analysis; compare against frame at double the size
+            Resampler resampler(96000, 48000);
+            std::vector<std::int16_t> output(resampler.getMaxOutput(size));
+            results.push_back(runKernel("resample_96k_48k", size, minSeconds, [&]() {
+                benchmarkSink = resampler.process(signal.data(), size, output.data(), output.size());
+            }));
+        }
+        if (wanted("resample_44k1_48k")) {
+            Resampler resampler(44100, 48000);
+            std::vector<std::int16_t> output(resampler.getMaxOutput(size));
+            results.push_back(runKernel("resample_44k1_48k", size, minSeconds, [&]() {
+                benchmarkSink = resampler.process(signal.data(), size, output.data(), output.size());
+            }));
+        }
+        if (wanted("hsv_to_rgb")) {
+            // One conversion per "sample" so the numbers line up with the audio kernels
+            results.push_back(runKernel("hsv_to_rgb", size, minSeconds, [&]() {
+                unsigned int acc = 0;
+                for (size_t i = 0; i < size; ++i) {
+                    double hue = static_cast<double>(i) / size;
+                    RGBColor c = HSVtoRGB(hue, 1.0, 1.0 - hue * 0.5);
+                    acc += c.r + c.g + c.b;
+                }
+                benchmarkSink = static_cast<float>(acc);
+            }));
+        }
+    }
+
+    std::cout << std::left << std::setw(20) << "kernel"
+              << std::right << std::setw(8) << "size"
+              << std::setw(16) << "ns/frame"
+              << std::setw(18) << "samples/s" << "\n";
+    for (const BenchmarkResult& r : results) {
+        std::cout << std::left << std::setw(20) << r.kernel
+                  << std::right << std::setw(8) << r.bufferSize
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(16) << r.nsPerFrame
+                  << std::setprecision(0)
+                  << std::setw(18) << r.samplesPerSecond << "\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+
+    if (!jsonPath.empty()) {
+        writeJson(jsonPath, results);
+    }
+
+    return 0;
+}
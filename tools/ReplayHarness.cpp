@@ -0,0 +1,248 @@
+// ReplayHarness.cpp
+// Pushes a WAV file through the full analysis -> lighting pipeline as fast as
+// possible, logs every feature snapshot and DMX frame, and optionally diffs
+// the log against a golden file. Throughput is reported as a real-time
+// multiple so performance and behaviour changes show up in the same run.
+
+#include "AllocationTracker.hpp"
+#include "AnalysisPipeline.hpp"
+#include "LightingEngine.hpp"
+#include "ReplayLog.hpp"
+#include "WavReader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: ReplayHarness <input.wav> [options]\n"
+              << "  --log <file>            Write the replay log (default replay.imlr)\n"
+              << "  --golden <file>         Compare the replay against a golden log\n"
+              << "  --tolerance <value>     Absolute feature tolerance (default 1e-4)\n"
+              << "  --dmx-tolerance <n>     Allowed DMX level difference (default 1)\n"
+              << "  --chunk <samples>       Samples per push, mimicking capture callbacks (default 441)\n"
+              << "  --config <file>         Analysis settings (sample_rate is taken from the WAV)\n"
+              << "  --analysis-rate <hz>    Resample the file to this rate before analysis\n"
+              << "  --frame <samples>       Analysis frame size (default 1024)\n"
+              << "  --hop <samples>         Analysis hop size (default 512)\n"
+              << "  --features <a,b,...>    Extra features to compute and log, e.g. flux,onset,mel_bands\n"
+              << "  --fingerprint-index <f> Recognise tracks from a BatchAnalyzer fingerprint index\n"
+              << "  --follow <timeline>     Follow a pre-analysed timeline (.imft with mel_bands)\n"
+              << "  --strobe <address>      Also patch a strobe at this DMX address (as the app does at 5)\n"
+              << "  --check-allocations     Fail if the pipeline allocates after warm-up\n"
+              << "                          (needs a build with -DIML_TRACK_ALLOCATIONS)\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    std::string inputPath = argv[1];
+    std::string logPath = "replay.imlr";
+    std::string goldenPath;
+    ReplayTolerance tolerance;
+    size_t chunkSize = 441;
+    AnalysisConfig config;
+    std::string configError;
+    bool checkAllocations = false;
+    size_t strobeAddress = 0;
+    const size_t warmupHops = 16;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--log" && hasValue) {
+            logPath = argv[++i];
+        }
+        else if (arg == "--golden" && hasValue) {
+            goldenPath = argv[++i];
+        }
+        else if (arg == "--tolerance" && hasValue) {
+            tolerance.feature = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (arg == "--dmx-tolerance" && hasValue) {
+            tolerance.dmx = std::atoi(argv[++i]);
+        }
+        else if (arg == "--chunk" && hasValue) {
+            chunkSize = std::max<size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--config" && hasValue) {
+            if (!config.loadFromFile(argv[++i], configError)) {
+                std::cerr << configError << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--analysis-rate" && hasValue) {
+            config.analysisRate = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--frame" && hasValue) {
+            config.frameSize = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--hop" && hasValue) {
+            config.hopSize = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--features" && hasValue) {
+            std::stringstream list(argv[++i]);
+            std::string feature;
+            while (std::getline(list, feature, ',')) {
+                config.features.push_back(feature);
+            }
+        }
+        else if (arg == "--fingerprint-index" && hasValue) {
+            config.fingerprintIndex = argv[++i];
+        }
+        else if (arg == "--follow" && hasValue) {
+            config.followTimeline = argv[++i];
+        }
+        else if (arg == "--strobe" && hasValue) {
+            strobeAddress = std::min<size_t>(DMX_UNIVERSE_SIZE, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--check-allocations") {
+            checkAllocations = true;
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (checkAllocations && !AllocationTracker::isEnabled()) {
+        std::cerr << "--check-allocations needs a build with -DIML_TRACK_ALLOCATIONS\n";
+        return 1;
+    }
+
+    WavReader wav;
+    if (!wav.load(inputPath)) {
+        std::cerr << wav.getError() << "\n";
+        return 1;
+    }
+    std::vector<std::int16_t> samples = wav.getMonoSamples();
+
+    config.sampleRate = wav.getSampleRate();
+    if (!config.validate(configError)) {
+        std::cerr << configError << "\n";
+        return 1;
+    }
+
+    std::unique_ptr<AnalysisPipeline> pipelinePtr;
+    try {
+        pipelinePtr = std::make_unique<AnalysisPipeline>(config);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    AnalysisPipeline& pipeline = *pipelinePtr;
+    LightingEngine lighting(1, strobeAddress);
+    DmxFrame frame;
+
+    // Render once so the log header knows how many DMX channels are patched
+    lighting.render(pipeline.getSnapshot(), frame);
+
+    ReplayLogWriter writer;
+    if (!writer.open(logPath, config.getAnalysisRate(), static_cast<unsigned int>(config.hopSize), frame.usedChannels)) {
+        std::cerr << "Could not open " << logPath << " for writing\n";
+        return 1;
+    }
+
+    size_t hops = 0;
+    size_t steadyHops = 0;
+    double firstMatchTime = -1.0;
+    FeatureSnapshot firstMatch;
+    AllocationTracker::resetCount();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t pos = 0; pos < samples.size();) {
+        // Only the analysis and lighting path is checked, resampling and
+        // buffering included; log writing may allocate
+        size_t count = std::min(chunkSize, samples.size() - pos);
+        if (checkAllocations && hops >= warmupHops) {
+            AllocationTracker::arm(false);
+        }
+        pos += pipeline.pushSamples(samples.data() + pos, count);
+        AllocationTracker::disarm();
+
+        while (true) {
+            bool steadyState = checkAllocations && hops >= warmupHops;
+            if (steadyState) {
+                AllocationTracker::arm(false);
+            }
+            bool produced = pipeline.processHop();
+            if (produced) {
+                lighting.render(pipeline.getSnapshot(), frame);
+            }
+            AllocationTracker::disarm();
+
+            if (!produced) {
+                break;
+            }
+            writer.write(pipeline.getSnapshot(), frame);
+            if (firstMatchTime < 0.0 && pipeline.getSnapshot().matchedTrack > 0.0f) {
+                firstMatch = pipeline.getSnapshot();
+                firstMatchTime = firstMatch.time;
+            }
+            ++hops;
+            steadyHops += steadyState ? 1 : 0;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    writer.close();
+
+    double audioSeconds = static_cast<double>(samples.size()) / wav.getSampleRate();
+    std::cout << std::fixed << std::setprecision(3)
+              << "Replayed " << audioSeconds << " s of audio (" << hops << " hops) in "
+              << elapsed << " s: " << std::setprecision(1)
+              << (elapsed > 0.0 ? audioSeconds / elapsed : 0.0) << "x real time\n";
+
+    if (!config.fingerprintIndex.empty()) {
+        if (firstMatchTime < 0.0) {
+            std::cout << "No track recognised\n";
+        }
+        else {
+            std::cout << std::setprecision(2) << "Recognised track " << static_cast<int>(firstMatch.matchedTrack) - 1
+                      << " after " << firstMatchTime << " s at position " << firstMatch.trackPosition
+                      << " s (" << static_cast<int>(firstMatch.matchVotes) << " votes)\n";
+        }
+    }
+
+    if (!config.followTimeline.empty()) {
+        const FeatureSnapshot& last = pipeline.getSnapshot();
+        std::cout << std::setprecision(2) << "Followed the reference to " << last.referencePosition << " s after "
+                  << last.time << " s of audio (path cost " << std::setprecision(3) << last.followCost << ")\n";
+    }
+
+    int exitCode = 0;
+    if (checkAllocations) {
+        size_t allocations = AllocationTracker::getCount();
+        std::cout << "Steady-state allocations: " << allocations << " over " << steadyHops
+                  << " hops (after " << warmupHops << " warm-up hops)\n";
+        if (allocations > 0) {
+            exitCode = 3;
+        }
+    }
+
+    if (goldenPath.empty()) {
+        return exitCode;
+    }
+
+    ReplayLog golden;
+    ReplayLog actual;
+    if (!golden.load(goldenPath) || !actual.load(logPath)) {
+        std::cerr << golden.getError() << actual.getError() << "\n";
+        return 1;
+    }
+
+    ReplayComparison comparison = compareReplayLogs(golden, actual, tolerance);
+    std::cout << std::defaultfloat << comparison.report
+              << (comparison.matches ? "MATCH" : "MISMATCH") << " against " << goldenPath << "\n";
+    return comparison.matches ? exitCode : 2;
+}
@@ -0,0 +1,64 @@
+// TimelineInspect.cpp
+// Prints the layout of a feature timeline (.imft) and the features at given
+// timestamps. Also reports how long opening the file took, which should stay
+// in the sub-millisecond range whatever the length of the show.
+
+#include "FeatureTimeline.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: TimelineInspect <timeline.imft> [--at <seconds>]...\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<double> seekTimes;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--at" && i + 1 < argc) {
+            seekTimes.push_back(std::atof(argv[++i]));
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    FeatureTimeline timeline;
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    if (!timeline.open(argv[1], error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    double openMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(3)
+              << argv[1] << ": " << timeline.getRowCount() << " rows, " << timeline.getColumnCount()
+              << " columns, " << timeline.getDuration() << " s at " << timeline.getSampleRate()
+              << " Hz / hop " << timeline.getHopSize() << "\n"
+              << "Opened in " << openMs << " ms\n";
+
+    for (double seconds : seekTimes) {
+        size_t row = timeline.findRow(seconds);
+        std::cout << "\nRow " << row << " (" << timeline.getTimes()[row] << " s):\n";
+        for (size_t c = 0; c < timeline.getColumnCount(); ++c) {
+            std::cout << "  " << std::left << std::setw(20) << timeline.getColumnName(c) << std::right
+                      << std::setprecision(6) << timeline.getColumn(c)[row] << "\n";
+        }
+    }
+    return 0;
+}